@@ -0,0 +1,140 @@
+// C API for the frontmatter package
+//
+// Other packages can detect front matter fences from their own C or C++ code,
+// without calling back into R. Add `LinkingTo: frontmatter` and
+// `Imports: frontmatter` to DESCRIPTION, then include this header:
+//
+//     #include <frontmatter.h>
+//
+//     frontmatter_extraction fm;
+//     if (frontmatter_extract(text, len, &fm) == FRONTMATTER_FOUND) {
+//       // YAML or TOML source is in text[fm.content_start, fm.content_end),
+//       // with each line starting with fm.comment_prefix (if not NULL)
+//     }
+//
+// frontmatter_extract() is looked up with R_GetCCallable() on first use, so
+// the first call must happen on the main R thread (with frontmatter loaded,
+// e.g. by importing it in NAMESPACE). Extraction itself never calls the R API
+// or allocates R objects: after the first call, it is safe to use from any
+// thread.
+//
+// The result struct may gain fields in later API versions. The caller's struct
+// size is passed along with it, so an installed frontmatter that is newer than
+// this header never writes past the end of the struct, and one that is older
+// leaves the fields it doesn't know about zeroed. frontmatter_api_version()
+// returns the API version of the installed package, to compare with
+// FRONTMATTER_API_VERSION.
+//
+// All offsets are byte positions into `text`. Nothing is copied: content
+// lines of comment-wrapped formats keep their comment prefix, which the caller
+// strips if needed.
+
+#ifndef FRONTMATTER_H
+#define FRONTMATTER_H
+
+#include <stddef.h>
+#include <string.h>
+#include <R_ext/Rdynload.h>
+
+#define FRONTMATTER_API_VERSION 1
+
+// Return value of frontmatter_extract() and `status` of the result
+enum frontmatter_status {
+  FRONTMATTER_FOUND = 0,
+  // No opening fence
+  FRONTMATTER_NOT_FOUND = 1,
+  // Opening fence without a matching closing fence
+  FRONTMATTER_UNCLOSED = 2,
+  // Invalid arguments (NULL `out`, a `struct_size` smaller than the version 1
+  // struct, or NULL `text` with non-zero `len`)
+  FRONTMATTER_ERROR = 3
+};
+
+enum frontmatter_format {
+  FRONTMATTER_FORMAT_NONE = 0,
+  FRONTMATTER_FORMAT_YAML = 1,
+  FRONTMATTER_FORMAT_TOML = 2
+};
+
+// Fence styles, in the same order as the `delimiter` names in R
+enum frontmatter_fence_type {
+  FRONTMATTER_FENCE_NONE = 0,
+  FRONTMATTER_FENCE_YAML = 1,
+  FRONTMATTER_FENCE_TOML = 2,
+  FRONTMATTER_FENCE_YAML_COMMENT = 3,
+  FRONTMATTER_FENCE_TOML_COMMENT = 4,
+  FRONTMATTER_FENCE_YAML_ROXY = 5,
+  FRONTMATTER_FENCE_TOML_ROXY = 6,
+  FRONTMATTER_FENCE_TOML_PEP723 = 7,
+  FRONTMATTER_FENCE_YAML_SQL_LINE = 8,
+  FRONTMATTER_FENCE_TOML_SQL_LINE = 9,
+  FRONTMATTER_FENCE_YAML_SQL_BLOCK_COMPACT = 10,
+  FRONTMATTER_FENCE_TOML_SQL_BLOCK_COMPACT = 11,
+  FRONTMATTER_FENCE_YAML_SQL_BLOCK_EXPANDED = 12,
+  FRONTMATTER_FENCE_TOML_SQL_BLOCK_EXPANDED = 13
+};
+
+// Enums are stored as int so that the layout doesn't depend on the compiler's
+// choice of enum size. Fields are only ever appended in later API versions.
+typedef struct frontmatter_extraction {
+  // Size of the struct as compiled by the caller, set by frontmatter_extract().
+  // On return, the number of bytes that were filled in.
+  size_t struct_size;
+  int status;
+  int format;
+  int fence_type;
+  // Comment prefix of each content line ("# ", "#' " or "-- "), or NULL.
+  // Points to static storage.
+  const char* comment_prefix;
+  // Front matter source, between the fences
+  size_t content_start;
+  size_t content_end;
+  // Body, after the closing fence and any leading empty or separator lines.
+  // Equal to `len` when the body is empty. When there is no front matter, the
+  // body is the whole text and `body_start` is 0.
+  size_t body_start;
+  // Length of a leading shebang line (including its newline) that belongs to
+  // the body of comment-wrapped formats, or 0
+  size_t shebang_end;
+} frontmatter_extraction;
+
+#ifndef FRONTMATTER_INTERNAL
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int (*frontmatter_extract_fn)(const char*, size_t, frontmatter_extraction*);
+typedef int (*frontmatter_api_version_fn)(void);
+
+// Scan `text` (`len` bytes, not necessarily NUL-terminated) for front matter
+// in any of the built-in fence styles and fill in `out`. A leading UTF-8 BOM
+// is not skipped. Returns `out->status`.
+static inline int frontmatter_extract(const char* text, size_t len, frontmatter_extraction* out) {
+  static frontmatter_extract_fn fn = NULL;
+  if (fn == NULL) {
+    fn = (frontmatter_extract_fn) R_GetCCallable("frontmatter", "frontmatter_extract");
+  }
+  if (out != NULL) {
+    memset(out, 0, sizeof(frontmatter_extraction));
+    out->struct_size = sizeof(frontmatter_extraction);
+  }
+  return fn(text, len, out);
+}
+
+// API version of the installed frontmatter package
+static inline int frontmatter_api_version(void) {
+  static frontmatter_api_version_fn fn = NULL;
+  if (fn == NULL) {
+    fn = (frontmatter_api_version_fn) R_GetCCallable("frontmatter", "frontmatter_api_version");
+  }
+  return fn();
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // FRONTMATTER_INTERNAL
+
+#endif  // FRONTMATTER_H
@@ -0,0 +1,104 @@
+#include "extract_front_matter.h"
+
+#define FRONTMATTER_INTERNAL
+#include "frontmatter.h"
+
+#include <R_ext/Rdynload.h>
+#include <algorithm>
+#include <cstddef>
+
+// Registered C API
+//
+// frontmatter_extract() is exported to other packages' native code with
+// R_RegisterCCallable(); see inst/include/frontmatter.h for the public
+// declarations. It is a thin adapter over scan_front_matter() and must never
+// call the R API, so that callers can use it from their own threads.
+//
+// Callers pass the size of their frontmatter_extraction struct in
+// `struct_size`. The result is built in a struct of the current size and only
+// the bytes the caller's struct has room for are copied back, so callers
+// compiled against an older header keep working when fields are appended.
+
+// Size of the version 1 struct, the smallest one callers can pass
+const size_t EXTRACTION_V1_SIZE = offsetof(frontmatter_extraction, shebang_end) + sizeof(size_t);
+
+// Helper: Map a fence type name to its stable C API value
+int fence_type_code(const char* fence_type) {
+  static const char* const names[] = {
+    "none",
+    "yaml",
+    "toml",
+    "yaml_comment",
+    "toml_comment",
+    "yaml_roxy",
+    "toml_roxy",
+    "toml_pep723",
+    "yaml_sql_line",
+    "toml_sql_line",
+    "yaml_sql_block_compact",
+    "toml_sql_block_compact",
+    "yaml_sql_block_expanded",
+    "toml_sql_block_expanded"
+  };
+
+  for (int i = 0; i < static_cast<int>(sizeof(names) / sizeof(names[0])); i++) {
+    if (strcmp(fence_type, names[i]) == 0) return i;
+  }
+  return FRONTMATTER_FENCE_NONE;
+}
+
+// Helper: Fill in a complete, zeroed result struct
+int fill_extraction(const char* text, size_t len, frontmatter_extraction* out) {
+  if (text == nullptr && len > 0) {
+    out->status = FRONTMATTER_ERROR;
+    return out->status;
+  }
+
+  FrontMatterScan scan = scan_front_matter(text, len);
+
+  if (!scan.found) {
+    out->status = scan.opened ? FRONTMATTER_UNCLOSED : FRONTMATTER_NOT_FOUND;
+    return out->status;
+  }
+
+  out->status = FRONTMATTER_FOUND;
+  out->format = strcmp(scan.format, "yaml") == 0 ? FRONTMATTER_FORMAT_YAML : FRONTMATTER_FORMAT_TOML;
+  out->fence_type = fence_type_code(scan.fence_type);
+  out->comment_prefix = scan.comment_prefix;
+  out->content_start = scan.content_start;
+  out->content_end = scan.content_end;
+  out->shebang_end = scan.shebang_end;
+
+  // Same body trimming as front_matter_result(), as an offset
+  const char* body = text + scan.body_start;
+  size_t body_len = len - scan.body_start;
+  out->body_start = scan.body_start + (scan.comment_prefix
+    ? skip_leading_comment_lines(body, body_len, scan.comment_prefix)
+    : skip_leading_empty_lines(body, body_len));
+
+  return out->status;
+}
+
+extern "C" int frontmatter_extract(const char* text, size_t len, frontmatter_extraction* out) {
+  if (out == nullptr || out->struct_size < EXTRACTION_V1_SIZE) {
+    return FRONTMATTER_ERROR;
+  }
+
+  frontmatter_extraction result;
+  memset(&result, 0, sizeof(frontmatter_extraction));
+  fill_extraction(text, len, &result);
+
+  result.struct_size = std::min(out->struct_size, sizeof(frontmatter_extraction));
+  memcpy(out, &result, result.struct_size);
+  return result.status;
+}
+
+extern "C" int frontmatter_api_version(void) {
+  return FRONTMATTER_API_VERSION;
+}
+
+[[cpp11::init]]
+void register_c_api(DllInfo* dll) {
+  R_RegisterCCallable("frontmatter", "frontmatter_extract", (DL_FUNC) &frontmatter_extract);
+  R_RegisterCCallable("frontmatter", "frontmatter_api_version", (DL_FUNC) &frontmatter_api_version);
+}
@@ -6,22 +6,80 @@
 #include <R_ext/Visibility.h>
 
 // extract_front_matter.cpp
-list extract_front_matter_cpp(std::string text);
-extern "C" SEXP _frontmatter_extract_front_matter_cpp(SEXP text) {
+list extract_front_matter_cpp(std::string text, std::string fence_type, bool stats);
+extern "C" SEXP _frontmatter_extract_front_matter_cpp(SEXP text, SEXP fence_type, SEXP stats) {
   BEGIN_CPP11
-    return cpp11::as_sexp(extract_front_matter_cpp(cpp11::as_cpp<cpp11::decay_t<std::string>>(text)));
+    return cpp11::as_sexp(extract_front_matter_cpp(cpp11::as_cpp<cpp11::decay_t<std::string>>(text), cpp11::as_cpp<cpp11::decay_t<std::string>>(fence_type), cpp11::as_cpp<cpp11::decay_t<bool>>(stats)));
+  END_CPP11
+}
+// extract_front_matter.cpp
+list extract_front_matter_custom_cpp(std::string text, std::string opener, std::string prefix, std::string closer, bool stats);
+extern "C" SEXP _frontmatter_extract_front_matter_custom_cpp(SEXP text, SEXP opener, SEXP prefix, SEXP closer, SEXP stats) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(extract_front_matter_custom_cpp(cpp11::as_cpp<cpp11::decay_t<std::string>>(text), cpp11::as_cpp<cpp11::decay_t<std::string>>(opener), cpp11::as_cpp<cpp11::decay_t<std::string>>(prefix), cpp11::as_cpp<cpp11::decay_t<std::string>>(closer), cpp11::as_cpp<cpp11::decay_t<bool>>(stats)));
+  END_CPP11
+}
+// find_front_matter.cpp
+list read_front_matter_headers_cpp(std::vector<std::string> paths, int threads);
+extern "C" SEXP _frontmatter_read_front_matter_headers_cpp(SEXP paths, SEXP threads) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(read_front_matter_headers_cpp(cpp11::as_cpp<cpp11::decay_t<std::vector<std::string>>>(paths), cpp11::as_cpp<cpp11::decay_t<int>>(threads)));
+  END_CPP11
+}
+// patch_front_matter.cpp
+list locate_front_matter_value_cpp(std::string text, std::string key, std::string fence_type);
+extern "C" SEXP _frontmatter_locate_front_matter_value_cpp(SEXP text, SEXP key, SEXP fence_type) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(locate_front_matter_value_cpp(cpp11::as_cpp<cpp11::decay_t<std::string>>(text), cpp11::as_cpp<cpp11::decay_t<std::string>>(key), cpp11::as_cpp<cpp11::decay_t<std::string>>(fence_type)));
+  END_CPP11
+}
+// patch_front_matter.cpp
+list locate_front_matter_value_custom_cpp(std::string text, std::string key, std::string opener, std::string prefix, std::string closer, std::string format);
+extern "C" SEXP _frontmatter_locate_front_matter_value_custom_cpp(SEXP text, SEXP key, SEXP opener, SEXP prefix, SEXP closer, SEXP format) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(locate_front_matter_value_custom_cpp(cpp11::as_cpp<cpp11::decay_t<std::string>>(text), cpp11::as_cpp<cpp11::decay_t<std::string>>(key), cpp11::as_cpp<cpp11::decay_t<std::string>>(opener), cpp11::as_cpp<cpp11::decay_t<std::string>>(prefix), cpp11::as_cpp<cpp11::decay_t<std::string>>(closer), cpp11::as_cpp<cpp11::decay_t<std::string>>(format)));
+  END_CPP11
+}
+// read_front_matter.cpp
+std::string read_front_matter_text_cpp(std::string path, bool header_only, std::string fence_type);
+extern "C" SEXP _frontmatter_read_front_matter_text_cpp(SEXP path, SEXP header_only, SEXP fence_type) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(read_front_matter_text_cpp(cpp11::as_cpp<cpp11::decay_t<std::string>>(path), cpp11::as_cpp<cpp11::decay_t<bool>>(header_only), cpp11::as_cpp<cpp11::decay_t<std::string>>(fence_type)));
+  END_CPP11
+}
+// read_ipynb.cpp
+list read_ipynb_first_cell_cpp(std::string path);
+extern "C" SEXP _frontmatter_read_ipynb_first_cell_cpp(SEXP path) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(read_ipynb_first_cell_cpp(cpp11::as_cpp<cpp11::decay_t<std::string>>(path)));
+  END_CPP11
+}
+// read_tar.cpp
+list read_tar_front_matter_cpp(std::string path, SEXP keep);
+extern "C" SEXP _frontmatter_read_tar_front_matter_cpp(SEXP path, SEXP keep) {
+  BEGIN_CPP11
+    return cpp11::as_sexp(read_tar_front_matter_cpp(cpp11::as_cpp<cpp11::decay_t<std::string>>(path), cpp11::as_cpp<cpp11::decay_t<SEXP>>(keep)));
   END_CPP11
 }
 
 extern "C" {
 static const R_CallMethodDef CallEntries[] = {
-    {"_frontmatter_extract_front_matter_cpp", (DL_FUNC) &_frontmatter_extract_front_matter_cpp, 1},
+    {"_frontmatter_extract_front_matter_cpp",             (DL_FUNC) &_frontmatter_extract_front_matter_cpp,             3},
+    {"_frontmatter_extract_front_matter_custom_cpp",      (DL_FUNC) &_frontmatter_extract_front_matter_custom_cpp,      5},
+    {"_frontmatter_locate_front_matter_value_cpp",        (DL_FUNC) &_frontmatter_locate_front_matter_value_cpp,        3},
+    {"_frontmatter_locate_front_matter_value_custom_cpp", (DL_FUNC) &_frontmatter_locate_front_matter_value_custom_cpp, 6},
+    {"_frontmatter_read_front_matter_headers_cpp",        (DL_FUNC) &_frontmatter_read_front_matter_headers_cpp,        2},
+    {"_frontmatter_read_front_matter_text_cpp",           (DL_FUNC) &_frontmatter_read_front_matter_text_cpp,           3},
+    {"_frontmatter_read_ipynb_first_cell_cpp",            (DL_FUNC) &_frontmatter_read_ipynb_first_cell_cpp,            1},
+    {"_frontmatter_read_tar_front_matter_cpp",            (DL_FUNC) &_frontmatter_read_tar_front_matter_cpp,            2},
     {NULL, NULL, 0}
 };
 }
 
+void register_c_api(DllInfo* dll);
 extern "C" attribute_visible void R_init_frontmatter(DllInfo* dll){
   R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
   R_useDynamicSymbols(dll, FALSE);
+  register_c_api(dll);
   R_forceSymbols(dll, TRUE);
 }
@@ -1,6 +1,5 @@
-#include <cpp11.hpp>
-#include <string>
-#include <cstring>
+#include "extract_front_matter.h"
+#include "xxh64.h"
 using namespace cpp11;
 
 // PEP 723 delimiter lengths
@@ -10,34 +9,6 @@ const size_t PEP723_OPENING_CHECK_LEN = 13;
 // Closing: "# ///" (5 chars)
 const size_t PEP723_CLOSING_LEN = 5;
 
-// Helper: Check if character is whitespace (space or tab)
-inline bool is_whitespace(char c) {
-  return c == ' ' || c == '\t';
-}
-
-// Helper: Check if we're at a newline (LF or CRLF)
-inline bool is_newline(const char* str, size_t pos, size_t len) {
-  if (pos >= len) return false;
-  if (str[pos] == '\n') return true;
-  if (str[pos] == '\r' && pos + 1 < len && str[pos + 1] == '\n') return true;
-  return false;
-}
-
-// Helper: Skip to next line, return position after newline
-inline size_t skip_to_next_line(const char* str, size_t pos, size_t len) {
-  while (pos < len && !is_newline(str, pos, len)) {
-    pos++;
-  }
-  if (pos < len) {
-    if (str[pos] == '\r' && pos + 1 < len && str[pos + 1] == '\n') {
-      pos += 2;  // CRLF
-    } else if (str[pos] == '\n') {
-      pos += 1;  // LF
-    }
-  }
-  return pos;
-}
-
 // Helper: Check if fence is valid at given position
 // Returns the position after the fence line (including newline), or 0 if invalid
 size_t validate_fence(const char* str, size_t pos, size_t len, const char* fence_chars, bool is_opening) {
@@ -82,36 +53,10 @@ size_t validate_fence(const char* str, size_t pos, size_t len, const char* fence
   return 0;
 }
 
-// Helper: Find closing fence starting from given position
-// Returns position where fence line starts, or 0 if not found
-size_t find_closing_fence(const char* str, size_t start_pos, size_t len, const char* fence_chars, size_t& content_end) {
-  size_t pos = start_pos;
-
-  while (pos < len) {
-    // Check if we're at start of a line and this could be a closing fence
-    bool at_line_start = (pos == start_pos) || is_newline(str, pos - 1, len) || (pos >= 2 && is_newline(str, pos - 2, len));
-
-    if (at_line_start && pos + 3 <= len) {
-      // Check if this is the closing fence
-      size_t fence_end = validate_fence(str, pos, len, fence_chars, false);
-      if (fence_end > 0) {
-        // Found valid closing fence
-        content_end = pos;
-        return pos;
-      }
-    }
-
-    // Not a closing fence, move to next line
-    pos = skip_to_next_line(str, pos, len);
-  }
-
-  return 0;  // No closing fence found
-}
-
-// Helper: Trim leading empty lines from body
-std::string trim_leading_empty_lines(const std::string& body) {
+// Helper: Find the start of the body after leading empty lines
+// Returns `len` if the body is empty
+size_t skip_leading_empty_lines(const char* body, size_t len) {
   size_t pos = 0;
-  size_t len = body.length();
 
   while (pos < len) {
     // Check if line is empty (only whitespace)
@@ -122,7 +67,7 @@ std::string trim_leading_empty_lines(const std::string& body) {
 
     // If we hit a newline or end, this line is empty/whitespace-only
     if (pos >= len) {
-      return "";  // Entire body is empty
+      return len;  // Entire body is empty
     }
 
     if (body[pos] == '\n') {
@@ -135,10 +80,10 @@ std::string trim_leading_empty_lines(const std::string& body) {
     }
 
     // Found non-whitespace, return from line start
-    return body.substr(line_start);
+    return line_start;
   }
 
-  return "";
+  return len;
 }
 
 // Helper: Check if line starts with comment prefix and fence
@@ -270,49 +215,12 @@ std::string unwrap_comments(const std::string& content, const char* prefix) {
   return result;
 }
 
-// Helper: Find closing fence for comment-wrapped format
-size_t find_comment_closing_fence(const char* str, size_t start_pos, size_t len, const char* fence_chars, const char* prefix, size_t& content_end) {
-  size_t pos = start_pos;
-
-  while (pos < len) {
-    // Check if we're at start of a line
-    bool at_line_start = (pos == start_pos) || is_newline(str, pos - 1, len) || (pos >= 2 && is_newline(str, pos - 2, len));
-
-    if (at_line_start) {
-      // Check if this line is the closing fence with same comment prefix
-      const char* found_prefix;
-      size_t fence_len = check_comment_fence(str, pos, len, fence_chars, &found_prefix);
-      if (fence_len > 0 && strcmp(found_prefix, prefix) == 0) {
-        // Validate it's a complete fence line
-        size_t check_pos = pos + fence_len;
-
-        // Allow trailing whitespace
-        while (check_pos < len && is_whitespace(str[check_pos])) {
-          check_pos++;
-        }
-
-        // Must end with newline or EOF
-        if (check_pos >= len || is_newline(str, check_pos, len)) {
-          content_end = pos;
-          return pos;
-        }
-      }
-    }
-
-    // Move to next line
-    pos = skip_to_next_line(str, pos, len);
-  }
-
-  return 0;
-}
-
-// Helper: Trim leading blank/comment-only lines (for comment-wrapped formats)
-// Only removes separator lines like "#" or "#'" - body is returned unchanged
-// Strips any number of empty lines but at most one bare comment line
-std::string trim_leading_comment_lines(const std::string& body, const char* prefix) {
-  const char* data = body.data();
+// Helper: Find the start of the body after leading blank/comment-only lines
+// (for comment-wrapped formats). Only skips separator lines like "#" or "#'":
+// any number of empty lines but at most one bare comment line. Returns `len`
+// if the body is only separator lines.
+size_t skip_leading_comment_lines(const char* data, size_t len, const char* prefix) {
   size_t pos = 0;
-  size_t len = body.length();
   size_t prefix_len = strlen(prefix);
   bool stripped_bare_comment = false;
 
@@ -392,12 +300,12 @@ std::string trim_leading_comment_lines(const std::string& body, const char* pref
       }
     }
 
-    // Found a non-separator line - return from here unchanged
-    return body.substr(line_start);
+    // Found a non-separator line - the body starts here unchanged
+    return line_start;
   }
 
   // Entire body was separator lines
-  return "";
+  return len;
 }
 
 // Helper: Check for SQL block comment opening (/* --- or /* then newline then ---)
@@ -462,65 +370,6 @@ size_t check_sql_block_opening(const char* str, size_t len, bool& is_compact, co
   return 0;
 }
 
-// Helper: Find closing fence for SQL block comment format
-// Returns 0 if not found, or position of fence line start. Sets content_end.
-size_t find_sql_block_closing(const char* str, size_t start_pos, size_t len, const char* fence_chars, bool is_compact, size_t& content_end) {
-  size_t pos = start_pos;
-
-  while (pos < len) {
-    bool at_line_start = (pos == start_pos) || is_newline(str, pos - 1, len) || (pos >= 2 && is_newline(str, pos - 2, len));
-
-    if (at_line_start && pos + 3 <= len && memcmp(str + pos, fence_chars, 3) == 0) {
-      // Check 4th char is not a fence char (exactly 3)
-      size_t after_fence = pos + 3;
-      if (after_fence < len && str[after_fence] == fence_chars[0]) {
-        pos = skip_to_next_line(str, pos, len);
-        continue;
-      }
-
-      if (is_compact) {
-        // Compact closer: fence then exactly " */" then optional trailing whitespace
-        size_t i = after_fence;
-        if (i >= len || str[i] != ' ') {
-          pos = skip_to_next_line(str, pos, len);
-          continue;
-        }
-        i++;
-        if (i + 2 <= len && str[i] == '*' && str[i + 1] == '/') {
-          i += 2;
-          while (i < len && is_whitespace(str[i])) i++;
-          if (i >= len || is_newline(str, i, len)) {
-            content_end = pos;
-            return pos;
-          }
-        }
-      } else {
-        // Expanded closer: fence then only whitespace until newline,
-        // then next line has optional whitespace, then "*/" then whitespace until newline/EOF
-        size_t i = after_fence;
-        while (i < len && is_whitespace(str[i])) i++;
-        if (i >= len || is_newline(str, i, len)) {
-          size_t next_line = skip_to_next_line(str, i, len);
-          size_t j = next_line;
-          while (j < len && is_whitespace(str[j])) j++;
-          if (j + 2 <= len && str[j] == '*' && str[j + 1] == '/') {
-            j += 2;
-            while (j < len && is_whitespace(str[j])) j++;
-            if (j >= len || is_newline(str, j, len)) {
-              content_end = pos;
-              return pos;
-            }
-          }
-        }
-      }
-    }
-
-    pos = skip_to_next_line(str, pos, len);
-  }
-
-  return 0;
-}
-
 // Helper: Check if line starts with PEP 723 opening delimiter
 bool is_pep723_opening(const char* str, size_t pos, size_t len) {
   // Must be exactly "# /// script" (# space /// space script)
@@ -555,310 +404,650 @@ bool is_pep723_closing(const char* str, size_t pos, size_t len) {
   return (i >= len || is_newline(str, i, len));
 }
 
-// Helper: Extract PEP 723 content
-list extract_pep723(const std::string& text, size_t start_pos, const std::string& shebang_prefix) {
-  const char* str = text.c_str();
-  size_t len = text.length();
-  writable::list result;
+// Closing fence policies
+//
+// Each policy inspects the line starting at `pos` and reports whether it closes
+// the front matter block, whether scanning should continue, or whether the
+// block is invalid. `find_closing()` is templated on the policy, so every
+// built-in fence style gets its own specialized scanning loop.
+enum LineMatch { LINE_CONTINUE, LINE_CLOSE, LINE_ABORT };
+
+// Helper: Check for exactly three fence characters `F` at `pos`
+template <char F>
+inline bool is_fence_at(const char* str, size_t pos, size_t len) {
+  return pos + 3 <= len && str[pos] == F && str[pos + 1] == F && str[pos + 2] == F;
+}
 
-  // Check for opening at start_pos
-  if (!is_pep723_opening(str, start_pos, len)) {
-    result.push_back({"found"_nm = false});
-    result.push_back({"format"_nm = "none"});
-    result.push_back({"fence_type"_nm = "none"});
-    result.push_back({"content"_nm = ""});
-    result.push_back({"body"_nm = text});
-    return result;
+// Standard closing fence: "---" or "+++" then only whitespace
+template <char F>
+struct StandardCloser {
+  LineMatch match(const char* str, size_t pos, size_t len) const {
+    if (is_fence_at<F>(str, pos, len) && is_blank_to_eol(str, pos + 3, len)) {
+      return LINE_CLOSE;
+    }
+    return LINE_CONTINUE;
   }
-
-  // Skip opening line
-  size_t pos = skip_to_next_line(str, start_pos, len);
-  size_t content_start = pos;
-
-  // Find closing delimiter and validate all lines in between
-  while (pos < len) {
-    // Check for closing delimiter
-    if (is_pep723_closing(str, pos, len)) {
-      // Found closing, extract content
-      std::string content;
-      if (pos > content_start) {
-        content = text.substr(content_start, pos - content_start);
-        // Unwrap "# " prefix from content
-        content = unwrap_comments(content, "# ");
-      }
-
-      // Extract body
-      size_t body_start = skip_to_next_line(str, pos, len);
-      std::string body;
-      if (body_start < len) {
-        body = text.substr(body_start);
-        // Use trim_leading_comment_lines to handle bare "#" separator lines
-        body = trim_leading_comment_lines(body, "# ");
+};
+
+// Comment-wrapped closing fence: same prefix as the opener, e.g. "# ---"
+template <char F>
+struct CommentCloser {
+  const char* prefix;
+  size_t prefix_len;
+
+  LineMatch match(const char* str, size_t pos, size_t len) const {
+    if (pos + prefix_len <= len && memcmp(str + pos, prefix, prefix_len) == 0 &&
+        is_fence_at<F>(str, pos + prefix_len, len) &&
+        is_blank_to_eol(str, pos + prefix_len + 3, len)) {
+      return LINE_CLOSE;
+    }
+    return LINE_CONTINUE;
+  }
+};
+
+// SQL block comment closing fence: "--- */" (compact) or "---" + "*/" (expanded)
+template <char F, bool Compact>
+struct SqlBlockCloser {
+  LineMatch match(const char* str, size_t pos, size_t len) const {
+    if (!is_fence_at<F>(str, pos, len)) return LINE_CONTINUE;
+
+    // Check 4th char is not a fence char (exactly 3)
+    size_t i = pos + 3;
+    if (i < len && str[i] == F) return LINE_CONTINUE;
+
+    if (Compact) {
+      // Compact closer: fence then exactly " */" then optional trailing whitespace
+      if (i >= len || str[i] != ' ') return LINE_CONTINUE;
+      i++;
+      if (i + 2 <= len && str[i] == '*' && str[i + 1] == '/' &&
+          is_blank_to_eol(str, i + 2, len)) {
+        return LINE_CLOSE;
       }
-      body = shebang_prefix + body;
+      return LINE_CONTINUE;
+    }
 
-      result.push_back({"found"_nm = true});
-      result.push_back({"format"_nm = "toml"});
-      result.push_back({"fence_type"_nm = "toml_pep723"});
-      result.push_back({"content"_nm = content});
-      result.push_back({"body"_nm = body});
-      return result;
+    // Expanded closer: fence then only whitespace until newline, then next
+    // line has optional whitespace, then "*/" then whitespace until newline/EOF
+    if (!is_blank_to_eol(str, i, len)) return LINE_CONTINUE;
+    size_t j = skip_to_next_line(str, i, len);
+    while (j < len && is_whitespace(str[j])) j++;
+    if (j + 2 <= len && str[j] == '*' && str[j + 1] == '/' &&
+        is_blank_to_eol(str, j + 2, len)) {
+      return LINE_CLOSE;
     }
+    return LINE_CONTINUE;
+  }
+};
+
+// PEP 723 closing delimiter; every line before it must be a "#" comment
+struct Pep723Closer {
+  LineMatch match(const char* str, size_t pos, size_t len) const {
+    if (is_pep723_closing(str, pos, len)) return LINE_CLOSE;
 
     // Validate this line starts with "#"
-    if (str[pos] != '#') {
-      // Invalid PEP 723 block
-      result.push_back({"found"_nm = false});
-      result.push_back({"format"_nm = "none"});
-      result.push_back({"fence_type"_nm = "none"});
-      result.push_back({"content"_nm = ""});
-      result.push_back({"body"_nm = text});
-      return result;
-    }
+    if (str[pos] != '#') return LINE_ABORT;
 
     // If there's content after #, must have space
     if (pos + 1 < len && str[pos + 1] != '\n' && str[pos + 1] != '\r' && str[pos + 1] != ' ') {
-      // Invalid: no space after #
-      result.push_back({"found"_nm = false});
-      result.push_back({"format"_nm = "none"});
-      result.push_back({"fence_type"_nm = "none"});
-      result.push_back({"content"_nm = ""});
-      result.push_back({"body"_nm = text});
-      return result;
+      return LINE_ABORT;
     }
+    return LINE_CONTINUE;
+  }
+};
+
+// Helper: Find the line that closes the front matter block
+// Returns position where the closing line starts, or 0 if not found
+//
+// With `resume`, the search starts at `*resume` when that is past `start_pos`,
+// and `*resume` is set to where a search over more input should start again:
+// the line before the last one checked, because the last line may be
+// incomplete and closers may look ahead one line. A line that aborts the
+// search is checked again, so that it still aborts it.
+template <typename Closer>
+size_t find_closing(const char* str, size_t start_pos, size_t len, const Closer& closer, size_t* resume = nullptr) {
+  size_t pos = start_pos;
+  if (resume && *resume > pos) {
+    pos = *resume;
+  }
+  size_t last = pos;
+  size_t before_last = pos;
 
-    // Move to next line
+  while (pos < len) {
+    before_last = last;
+    last = pos;
+
+    LineMatch m = closer.match(str, pos, len);
+    if (m == LINE_CLOSE) return pos;
+    if (m == LINE_ABORT) {
+      if (resume) *resume = pos;
+      return 0;
+    }
+
+    // Not a closing fence, move to next line
     pos = skip_to_next_line(str, pos, len);
   }
 
-  // No closing delimiter found
-  result.push_back({"found"_nm = false});
-  result.push_back({"format"_nm = "none"});
-  result.push_back({"fence_type"_nm = "none"});
-  result.push_back({"content"_nm = ""});
-  result.push_back({"body"_nm = text});
-  return result;
+  if (resume) *resume = before_last;
+  return 0;  // No closing fence found
 }
 
-[[cpp11::register]]
-list extract_front_matter_cpp(std::string text) {
-  const char* str = text.c_str();
-  size_t len = text.length();
+template <char F>
+size_t find_comment_closing(const char* str, size_t start_pos, size_t len, const char* prefix, size_t* resume) {
+  CommentCloser<F> closer = {prefix, strlen(prefix)};
+  return find_closing(str, start_pos, len, closer, resume);
+}
 
-  writable::list result;
+template <char F>
+size_t find_sql_block_closing(const char* str, size_t start_pos, size_t len, bool is_compact, size_t* resume) {
+  if (is_compact) {
+    return find_closing(str, start_pos, len, SqlBlockCloser<F, true>(), resume);
+  }
+  return find_closing(str, start_pos, len, SqlBlockCloser<F, false>(), resume);
+}
 
-  // Empty string
-  if (len == 0) {
-    result.push_back({"found"_nm = false});
-    result.push_back({"format"_nm = "none"});
-    result.push_back({"fence_type"_nm = "none"});
-    result.push_back({"content"_nm = ""});
-    result.push_back({"body"_nm = ""});
-    return result;
+// Helper: Position to resume the closing fence search of `fence_type` from,
+// or nullptr without a search. The search starts over when the opening fence
+// differs from the one of the previous scan.
+size_t* resume_closing_search(ClosingSearch* search, const char* fence_type) {
+  if (search == nullptr) return nullptr;
+  if (search->fence_type == nullptr || strcmp(search->fence_type, fence_type) != 0) {
+    search->fence_type = fence_type;
+    search->resume = 0;
   }
+  return &search->resume;
+}
 
-  // Shebang detection: if file starts with "#!", skip it and allow 0-1 blank lines
-  // before comment-wrapped opening fence
-  size_t search_start = 0;
-  std::string shebang_prefix;
-  bool has_shebang = false;
+// Helper: Detect a shebang line ("#!") at the start of the text
+// Returns the start of the first non-blank line after the shebang (allowing
+// 0-1 blank lines in between), or 0 if there is no usable shebang. Sets
+// `shebang_end` to the position after the shebang line.
+size_t detect_shebang(const char* str, size_t len, size_t& shebang_end) {
+  shebang_end = 0;
+  if (len < 2 || str[0] != '#' || str[1] != '!') return 0;
 
-  if (len >= 2 && str[0] == '#' && str[1] == '!') {
-    size_t after_shebang = skip_to_next_line(str, 0, len);
-    size_t pos = after_shebang;
-    int blank_count = 0;
+  size_t after_shebang = skip_to_next_line(str, 0, len);
+  size_t pos = after_shebang;
+  int blank_count = 0;
 
-    while (pos < len) {
-      size_t line_start = pos;
-      while (pos < len && is_whitespace(str[pos])) pos++;
+  while (pos < len) {
+    size_t line_start = pos;
+    while (pos < len && is_whitespace(str[pos])) pos++;
 
-      if (pos >= len) break;
+    if (pos >= len) break;
 
-      if (is_newline(str, pos, len)) {
-        blank_count++;
-        pos = skip_to_next_line(str, pos, len);
-        if (blank_count > 1) break;
-      } else {
-        if (blank_count <= 1) {
-          has_shebang = true;
-          search_start = line_start;
-          shebang_prefix = text.substr(0, after_shebang);
-        }
-        break;
+    if (is_newline(str, pos, len)) {
+      blank_count++;
+      pos = skip_to_next_line(str, pos, len);
+      if (blank_count > 1) break;
+    } else {
+      if (blank_count <= 1) {
+        shebang_end = after_shebang;
+        return line_start;
       }
+      break;
     }
   }
 
+  return 0;
+}
+
+// Helper: Scan for front matter in any of the built-in fence styles
+FrontMatterScan scan_front_matter(const char* str, size_t len, ClosingSearch* search) {
+  FrontMatterScan scan;
+
+  if (len == 0) {
+    return scan;
+  }
+
+  // Shebang detection: if file starts with "#!", skip it and allow 0-1 blank
+  // lines before comment-wrapped opening fence
+  size_t shebang_end = 0;
+  size_t search_start = detect_shebang(str, len, shebang_end);
+
   // Check for PEP 723 format first (has most specific opening)
-  size_t pep723_search = has_shebang ? search_start : 0;
-  if (is_pep723_opening(str, pep723_search, len)) {
-    return extract_pep723(text, pep723_search, shebang_prefix);
+  if (is_pep723_opening(str, search_start, len)) {
+    scan.opened = true;
+    scan.content_start = skip_to_next_line(str, search_start, len);
+    size_t closing_start = find_closing(str, scan.content_start, len, Pep723Closer(), resume_closing_search(search, "toml_pep723"));
+    if (closing_start == 0) {
+      return scan;
+    }
+
+    scan.found = true;
+    scan.format = "toml";
+    scan.fence_type = "toml_pep723";
+    scan.comment_prefix = "# ";
+    scan.shebang_end = shebang_end;
+    scan.content_end = closing_start;
+    scan.body_start = skip_to_next_line(str, closing_start, len);
+    return scan;
   }
 
-  // Check for opening fence at position 0 (or after shebang for comment-wrapped)
-  const char* fence_chars = nullptr;
-  std::string format;
-  std::string fence_type;
+  size_t closing_start = 0;
+  bool sql_block_expanded = false;
+
+  // Try comment-wrapped YAML or TOML (# ---, #' ---, -- ---, # +++, ...)
   const char* comment_prefix = nullptr;
-  size_t opening_end = 0;
-  bool is_comment_wrapped = false;
-  bool is_sql_block = false;
-  bool sql_block_compact = false;
-
-  size_t comment_search = has_shebang ? search_start : 0;
-
-  // Try comment-wrapped YAML (# --- or #' ---)
-  size_t comment_fence_len = check_comment_fence(str, comment_search, len, "---", &comment_prefix);
-  if (comment_fence_len > 0) {
-    size_t check_pos = comment_search + comment_fence_len;
-    while (check_pos < len && is_whitespace(str[check_pos])) {
-      check_pos++;
-    }
-    if (check_pos >= len || is_newline(str, check_pos, len)) {
-      fence_chars = "---";
-      format = "yaml";
-      if (strcmp(comment_prefix, "# ") == 0) {
-        fence_type = "yaml_comment";
-      } else if (strcmp(comment_prefix, "-- ") == 0) {
-        fence_type = "yaml_sql_line";
-      } else {
-        fence_type = "yaml_roxy";
-      }
-      is_comment_wrapped = true;
-      opening_end = skip_to_next_line(str, comment_search, len);
-    }
+  const char* fence_chars = "---";
+  size_t comment_fence_len = check_comment_fence(str, search_start, len, fence_chars, &comment_prefix);
+  if (comment_fence_len == 0) {
+    fence_chars = "+++";
+    comment_fence_len = check_comment_fence(str, search_start, len, fence_chars, &comment_prefix);
   }
 
-  // Try comment-wrapped TOML (# +++ or #' +++)
-  if (!fence_chars) {
-    comment_fence_len = check_comment_fence(str, comment_search, len, "+++", &comment_prefix);
-    if (comment_fence_len > 0) {
-      size_t check_pos = comment_search + comment_fence_len;
-      while (check_pos < len && is_whitespace(str[check_pos])) {
-        check_pos++;
-      }
-      if (check_pos >= len || is_newline(str, check_pos, len)) {
-        fence_chars = "+++";
-        format = "toml";
-        if (strcmp(comment_prefix, "# ") == 0) {
-          fence_type = "toml_comment";
-        } else if (strcmp(comment_prefix, "-- ") == 0) {
-          fence_type = "toml_sql_line";
-        } else {
-          fence_type = "toml_roxy";
-        }
-        is_comment_wrapped = true;
-        opening_end = skip_to_next_line(str, comment_search, len);
-      }
+  if (comment_fence_len > 0 && is_blank_to_eol(str, search_start + comment_fence_len, len)) {
+    bool is_yaml = fence_chars[0] == '-';
+    scan.opened = true;
+    scan.format = is_yaml ? "yaml" : "toml";
+    if (strcmp(comment_prefix, "# ") == 0) {
+      scan.fence_type = is_yaml ? "yaml_comment" : "toml_comment";
+    } else if (strcmp(comment_prefix, "-- ") == 0) {
+      scan.fence_type = is_yaml ? "yaml_sql_line" : "toml_sql_line";
+    } else {
+      scan.fence_type = is_yaml ? "yaml_roxy" : "toml_roxy";
     }
+    scan.comment_prefix = comment_prefix;
+    scan.shebang_end = shebang_end;
+    scan.content_start = skip_to_next_line(str, search_start, len);
+    size_t* resume = resume_closing_search(search, scan.fence_type);
+    closing_start = is_yaml
+      ? find_comment_closing<'-'>(str, scan.content_start, len, comment_prefix, resume)
+      : find_comment_closing<'+'>(str, scan.content_start, len, comment_prefix, resume);
   }
 
   // Try SQL block comment (/* --- or /* then newline then ---)
-  if (!fence_chars) {
+  if (!scan.opened) {
+    bool compact = false;
     const char* sql_fence = nullptr;
-    size_t sql_content_start = check_sql_block_opening(str, len, sql_block_compact, sql_fence);
+    size_t sql_content_start = check_sql_block_opening(str, len, compact, sql_fence);
     if (sql_content_start > 0) {
-      fence_chars = sql_fence;
-      format = (strcmp(fence_chars, "---") == 0) ? "yaml" : "toml";
-      fence_type = (strcmp(fence_chars, "---") == 0)
-        ? (sql_block_compact ? "yaml_sql_block_compact" : "yaml_sql_block_expanded")
-        : (sql_block_compact ? "toml_sql_block_compact" : "toml_sql_block_expanded");
-      is_sql_block = true;
-      opening_end = sql_content_start;
+      bool is_yaml = sql_fence[0] == '-';
+      scan.opened = true;
+      scan.format = is_yaml ? "yaml" : "toml";
+      scan.fence_type = is_yaml
+        ? (compact ? "yaml_sql_block_compact" : "yaml_sql_block_expanded")
+        : (compact ? "toml_sql_block_compact" : "toml_sql_block_expanded");
+      scan.content_start = sql_content_start;
+      sql_block_expanded = !compact;
+      size_t* resume = resume_closing_search(search, scan.fence_type);
+      closing_start = is_yaml
+        ? find_sql_block_closing<'-'>(str, sql_content_start, len, compact, resume)
+        : find_sql_block_closing<'+'>(str, sql_content_start, len, compact, resume);
     }
   }
 
-  // Try standard YAML (---)
-  if (!fence_chars) {
-    opening_end = validate_fence(str, 0, len, "---", true);
+  // Try standard YAML (---) or TOML (+++)
+  if (!scan.opened) {
+    size_t opening_end = validate_fence(str, 0, len, "---", true);
     if (opening_end > 0) {
-      fence_chars = "---";
-      format = "yaml";
-      fence_type = "yaml";
+      scan.opened = true;
+      scan.format = "yaml";
+      scan.fence_type = "yaml";
+      scan.content_start = opening_end;
+      closing_start = find_closing(str, opening_end, len, StandardCloser<'-'>(), resume_closing_search(search, "yaml"));
+    } else {
+      opening_end = validate_fence(str, 0, len, "+++", true);
+      if (opening_end > 0) {
+        scan.opened = true;
+        scan.format = "toml";
+        scan.fence_type = "toml";
+        scan.content_start = opening_end;
+        closing_start = find_closing(str, opening_end, len, StandardCloser<'+'>(), resume_closing_search(search, "toml"));
+      }
     }
   }
 
-  // Try standard TOML (+++)
-  if (!fence_chars) {
-    opening_end = validate_fence(str, 0, len, "+++", true);
-    if (opening_end > 0) {
-      fence_chars = "+++";
-      format = "toml";
-      fence_type = "toml";
+  if (closing_start == 0) {
+    // No valid opening or closing fence found
+    scan.format = "none";
+    scan.fence_type = "none";
+    scan.comment_prefix = nullptr;
+    scan.shebang_end = 0;
+    return scan;
+  }
+
+  scan.found = true;
+  scan.content_end = closing_start;
+
+  // Body starts after the closing fence line; expanded SQL blocks also skip
+  // the "*/" line
+  scan.body_start = skip_to_next_line(str, closing_start, len);
+  if (sql_block_expanded) {
+    scan.body_start = skip_to_next_line(str, scan.body_start, len);
+  }
+
+  return scan;
+}
+
+bool is_header_scan_complete(const char* str, size_t len, const FrontMatterScan& scan) {
+  if (scan.found) {
+    // The closing fence line (and the "*/" line of expanded SQL blocks) must
+    // be complete, otherwise more input could still invalidate it
+    return scan.body_start > 0 && str[scan.body_start - 1] == '\n';
+  }
+
+  if (scan.opened) {
+    return false;
+  }
+
+  // Every opening fence starts with one of these characters, which quickly
+  // rules out binary files and documents without front matter
+  if (len > 0 && str[0] != '-' && str[0] != '+' && str[0] != '#' && str[0] != '/') {
+    return true;
+  }
+
+  // Opening fences span at most three lines (shebang, blank line, fence), so
+  // once those are complete no opening fence can match
+  int lines = 0;
+  for (size_t i = 0; i < len && lines < 3; i++) {
+    if (str[i] == '\n') lines++;
+  }
+  return lines >= 3;
+}
+
+std::string unwrap_custom_prefix(const std::string& content, const CustomFence& fence);
+size_t skip_leading_custom_lines(const char* data, size_t len, const CustomFence& fence);
+
+std::string front_matter_content(const std::string& text, const FrontMatterScan& scan) {
+  std::string content;
+  if (scan.found && scan.content_end > scan.content_start) {
+    content = text.substr(scan.content_start, scan.content_end - scan.content_start);
+    // Unwrap comments if needed
+    if (scan.custom) {
+      content = unwrap_custom_prefix(content, *scan.custom);
+    } else if (scan.comment_prefix) {
+      content = unwrap_comments(content, scan.comment_prefix);
+    }
+  }
+  return content;
+}
+
+// Counts the lines and words of the body while it is hashed
+struct BodyCounter {
+  double lines = 0;
+  double words = 0;
+  bool in_word = false;
+
+  void operator()(const char* p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      char c = p[i];
+      bool space = c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+      if (!space && !in_word) words++;
+      in_word = !space;
+      if (c == '\n') lines++;
+    }
+  }
+};
+
+// Helper: Add content and body statistics to the result list
+// The body is measured as parse_front_matter() returns it, i.e. the shebang
+// line (if any) followed by the text from `body_start`, without the trailing
+// newline that is dropped when front matter was found. Both pieces are read
+// from the original text rather than from a copy of the body.
+void push_front_matter_stats(writable::list& result, const std::string& content, const std::string& text, size_t shebang_end, size_t body_start, bool found) {
+  const char* str = text.data();
+  size_t body_end = text.length();
+  if (found) {
+    // The newline may end the shebang line when nothing follows it
+    size_t start = body_end > body_start ? body_start : 0;
+    size_t& end = body_end > body_start ? body_end : shebang_end;
+    if (end > start && str[end - 1] == '\n') {
+      end--;
+      if (end > start && str[end - 1] == '\r') end--;
     }
   }
 
-  // No valid opening fence found
-  if (!fence_chars) {
+  // Hashing and counting share a single pass over the body
+  BodyCounter counter;
+  Xxh64 body_hash;
+  body_hash.update(str, shebang_end, counter);
+  if (body_end > body_start) {
+    body_hash.update(str + body_start, body_end - body_start, counter);
+  }
+  size_t body_len = shebang_end + (body_end > body_start ? body_end - body_start : 0);
+  char last = body_end > body_start ? str[body_end - 1] : (shebang_end > 0 ? str[shebang_end - 1] : '\0');
+  if (body_len > 0 && last != '\n') {
+    counter.lines++;
+  }
+
+  result.push_back({"content_hash"_nm = xxh64_hex(xxh64(content.data(), content.length()))});
+  result.push_back({"body_hash"_nm = xxh64_hex(body_hash.digest())});
+  result.push_back({"body_lines"_nm = counter.lines});
+  result.push_back({"body_words"_nm = counter.words});
+  result.push_back({"body_bytes"_nm = static_cast<double>(body_len)});
+}
+
+// Helper: Build the R result list from a scan
+list front_matter_result(const std::string& text, const FrontMatterScan& scan, bool stats) {
+  writable::list result;
+
+  if (!scan.found) {
     result.push_back({"found"_nm = false});
     result.push_back({"format"_nm = "none"});
     result.push_back({"fence_type"_nm = "none"});
     result.push_back({"content"_nm = ""});
     result.push_back({"body"_nm = text});
+    if (stats) {
+      push_front_matter_stats(result, "", text, 0, 0, false);
+    }
     return result;
   }
 
-  // Opening fence found, now find closing fence
-  size_t content_end;
-  size_t closing_start;
+  size_t len = text.length();
+  std::string content = front_matter_content(text, scan);
+
+  // The body is everything after the closing fence line, without leading
+  // empty (or comment separator) lines
+  size_t body_start = len;
+  if (scan.body_start < len) {
+    const char* rest = text.data() + scan.body_start;
+    size_t rest_len = len - scan.body_start;
+    if (scan.custom) {
+      body_start = scan.body_start + skip_leading_custom_lines(rest, rest_len, *scan.custom);
+    } else if (scan.comment_prefix) {
+      body_start = scan.body_start + skip_leading_comment_lines(rest, rest_len, scan.comment_prefix);
+    } else {
+      body_start = scan.body_start + skip_leading_empty_lines(rest, rest_len);
+    }
+  }
+
+  // Prepend shebang line to body for comment-wrapped formats
+  std::string body;
+  body.reserve(scan.shebang_end + len - body_start);
+  body.append(text, 0, scan.shebang_end);
+  body.append(text, body_start, std::string::npos);
 
-  if (is_sql_block) {
-    closing_start = find_sql_block_closing(str, opening_end, len, fence_chars, sql_block_compact, content_end);
-  } else if (is_comment_wrapped) {
-    closing_start = find_comment_closing_fence(str, opening_end, len, fence_chars, comment_prefix, content_end);
-  } else {
-    closing_start = find_closing_fence(str, opening_end, len, fence_chars, content_end);
+  result.push_back({"found"_nm = true});
+  result.push_back({"format"_nm = scan.format});
+  result.push_back({"fence_type"_nm = scan.fence_type});
+  result.push_back({"content"_nm = content});
+  result.push_back({"body"_nm = body});
+  if (stats) {
+    push_front_matter_stats(result, content, text, scan.shebang_end, body_start, true);
   }
+  return result;
+}
 
-  if (closing_start == 0) {
-    // No valid closing fence found or limits exceeded
-    result.push_back({"found"_nm = false});
-    result.push_back({"format"_nm = "none"});
-    result.push_back({"fence_type"_nm = "none"});
-    result.push_back({"content"_nm = ""});
-    result.push_back({"body"_nm = text});
-    return result;
+[[cpp11::register]]
+list extract_front_matter_cpp(std::string text, std::string fence_type, bool stats) {
+  FrontMatterScan scan = scan_front_matter(text.c_str(), text.length());
+
+  // Restrict to a single built-in fence style
+  if (!fence_type.empty() && fence_type != scan.fence_type) {
+    scan = FrontMatterScan();
   }
+  return front_matter_result(text, scan, stats);
+}
 
-  // Extract content between fences
-  std::string content;
-  if (content_end > opening_end) {
-    content = text.substr(opening_end, content_end - opening_end);
-    // Unwrap comments if needed
-    if (is_comment_wrapped) {
-      content = unwrap_comments(content, comment_prefix);
+// Custom delimiters
+//
+// A custom delimiter is the `c(opener, prefix, closer)` triple accepted by
+// format_front_matter(). The opener and closer may span several lines (e.g.
+// "/*\n---"). The spec is compiled once into a CustomFence and matched with
+// the same find_closing() scanner as the built-in fence styles.
+
+// Helper: Split a delimiter into lines, dropping any trailing "\r"
+std::vector<std::string> split_delimiter_lines(const std::string& x) {
+  std::vector<std::string> lines;
+  size_t start = 0;
+  while (true) {
+    size_t nl = x.find('\n', start);
+    std::string line = x.substr(start, nl == std::string::npos ? std::string::npos : nl - start);
+    if (!line.empty() && line[line.length() - 1] == '\r') {
+      line.erase(line.length() - 1);
     }
+    lines.push_back(line);
+    if (nl == std::string::npos) break;
+    start = nl + 1;
   }
+  return lines;
+}
+
+CustomFence compile_custom_fence(const std::string& opener, const std::string& prefix, const std::string& closer) {
+  CustomFence fence;
+  fence.opener_lines = split_delimiter_lines(opener);
+  fence.closer_lines = split_delimiter_lines(closer);
+  fence.prefix = prefix;
 
-  // Extract body (everything after closing fence line)
-  size_t body_start;
-  if (is_sql_block && !sql_block_compact) {
-    // Expanded: skip fence line, then skip */ line
-    size_t after_fence_line = skip_to_next_line(str, closing_start, len);
-    body_start = skip_to_next_line(str, after_fence_line, len);
-  } else {
-    body_start = skip_to_next_line(str, closing_start, len);
+  size_t bare_len = prefix.length();
+  while (bare_len > 0 && is_whitespace(prefix[bare_len - 1])) {
+    bare_len--;
   }
-  std::string body;
-  if (body_start < len) {
-    body = text.substr(body_start);
-    if (is_comment_wrapped) {
-      // For comment-wrapped formats, trim leading comment lines then unwrap remaining
-      body = trim_leading_comment_lines(body, comment_prefix);
-    } else {
-      body = trim_leading_empty_lines(body);
+  fence.bare_prefix = prefix.substr(0, bare_len);
+  return fence;
+}
+
+// Helper: Match a sequence of delimiter lines starting at `pos`
+// Each line must match literally, followed only by whitespace until newline or
+// EOF. Returns the position after the last matched line, or 0 if no match.
+size_t match_custom_lines(const char* str, size_t pos, size_t len, const std::vector<std::string>& lines) {
+  for (size_t k = 0; k < lines.size(); k++) {
+    const std::string& line = lines[k];
+    if (pos >= len && !line.empty()) return 0;
+    if (pos + line.length() > len || memcmp(str + pos, line.data(), line.length()) != 0) {
+      return 0;
     }
+    if (!is_blank_to_eol(str, pos + line.length(), len)) {
+      return 0;
+    }
+    pos = skip_to_next_line(str, pos + line.length(), len);
   }
+  return pos;
+}
 
-  // Prepend shebang line to body for comment-wrapped formats
-  if (has_shebang && is_comment_wrapped) {
-    body = shebang_prefix + body;
+struct CustomCloser {
+  const CustomFence* fence;
+
+  LineMatch match(const char* str, size_t pos, size_t len) const {
+    return match_custom_lines(str, pos, len, fence->closer_lines) > 0 ? LINE_CLOSE : LINE_CONTINUE;
+  }
+};
+
+// Helper: Check if the line at `pos` is a bare comment prefix (e.g. "#")
+// Returns the position after the line, or 0 if it is not
+size_t match_bare_prefix_line(const char* data, size_t pos, size_t len, const std::string& bare) {
+  if (bare.empty()) return 0;
+  if (pos + bare.length() > len || memcmp(data + pos, bare.data(), bare.length()) != 0) {
+    return 0;
+  }
+  if (!is_blank_to_eol(data, pos + bare.length(), len)) return 0;
+  return skip_to_next_line(data, pos + bare.length(), len);
+}
+
+// Helper: Remove the custom prefix from each content line
+// Bare prefix lines (e.g. "#" for a "# " prefix) become empty lines.
+std::string unwrap_custom_prefix(const std::string& content, const CustomFence& fence) {
+  if (fence.prefix.empty()) return content;
+
+  const char* data = content.data();
+  size_t len = content.length();
+  size_t prefix_len = fence.prefix.length();
+  std::string result;
+  result.reserve(len);
+
+  size_t pos = 0;
+  while (pos < len) {
+    size_t next = skip_to_next_line(data, pos, len);
+
+    if (pos + prefix_len <= len && memcmp(data + pos, fence.prefix.data(), prefix_len) == 0) {
+      result.append(data + pos + prefix_len, next - pos - prefix_len);
+    } else if (match_bare_prefix_line(data, pos, len, fence.bare_prefix) > 0) {
+      // Keep only the line ending
+      size_t eol = pos + fence.bare_prefix.length();
+      while (eol < next && data[eol] != '\r' && data[eol] != '\n') eol++;
+      result.append(data + eol, next - eol);
+    } else {
+      result.append(data + pos, next - pos);
+    }
+
+    pos = next;
   }
 
-  result.push_back({"found"_nm = true});
-  result.push_back({"format"_nm = format});
-  result.push_back({"fence_type"_nm = fence_type});
-  result.push_back({"content"_nm = content});
-  result.push_back({"body"_nm = body});
   return result;
 }
+
+// Helper: Skip leading empty lines and at most one bare prefix separator line
+size_t skip_leading_custom_lines(const char* data, size_t len, const CustomFence& fence) {
+  if (fence.bare_prefix.empty()) return skip_leading_empty_lines(data, len);
+
+  size_t pos = 0;
+  bool stripped_bare_comment = false;
+
+  while (pos < len) {
+    if (is_blank_to_eol(data, pos, len)) {
+      pos = skip_to_next_line(data, pos, len);
+      continue;
+    }
+
+    if (!stripped_bare_comment) {
+      size_t line_start = pos;
+      while (line_start < len && is_whitespace(data[line_start])) line_start++;
+      size_t next = match_bare_prefix_line(data, line_start, len, fence.bare_prefix);
+      if (next > 0) {
+        pos = next;
+        stripped_bare_comment = true;
+        continue;
+      }
+    }
+
+    return pos;
+  }
+
+  return len;
+}
+
+// Helper: Scan for front matter with a custom delimiter
+FrontMatterScan scan_custom_front_matter(const char* str, size_t len, const CustomFence& fence) {
+  FrontMatterScan scan;
+  if (len == 0) return scan;
+
+  // Comment-prefixed custom fences may follow a shebang line, like the
+  // built-in comment-wrapped formats
+  size_t shebang_end = 0;
+  size_t search_start = fence.prefix.empty() ? 0 : detect_shebang(str, len, shebang_end);
+
+  size_t opening_end = match_custom_lines(str, search_start, len, fence.opener_lines);
+  if (opening_end == 0) return scan;
+
+  scan.opened = true;
+  CustomCloser closer = {&fence};
+  size_t closing_start = find_closing(str, opening_end, len, closer);
+  if (closing_start == 0) return scan;
+
+  scan.found = true;
+  scan.format = "custom";
+  scan.fence_type = "custom";
+  scan.custom = &fence;
+  scan.shebang_end = shebang_end;
+  scan.content_start = opening_end;
+  scan.content_end = closing_start;
+  scan.body_start = match_custom_lines(str, closing_start, len, fence.closer_lines);
+  return scan;
+}
+
+[[cpp11::register]]
+list extract_front_matter_custom_cpp(std::string text, std::string opener, std::string prefix, std::string closer, bool stats) {
+  CustomFence fence = compile_custom_fence(opener, prefix, closer);
+  FrontMatterScan scan = scan_custom_front_matter(text.c_str(), text.length(), fence);
+  return front_matter_result(text, scan, stats);
+}
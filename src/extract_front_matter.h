@@ -0,0 +1,154 @@
+#ifndef FRONTMATTER_EXTRACT_FRONT_MATTER_H
+#define FRONTMATTER_EXTRACT_FRONT_MATTER_H
+
+#include <cpp11.hpp>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <vector>
+
+// Helper: Check if character is whitespace (space or tab)
+inline bool is_whitespace(char c) {
+  return c == ' ' || c == '\t';
+}
+
+// Helper: Check if we're at a newline (LF or CRLF)
+inline bool is_newline(const char* str, size_t pos, size_t len) {
+  if (pos >= len) return false;
+  if (str[pos] == '\n') return true;
+  if (str[pos] == '\r' && pos + 1 < len && str[pos + 1] == '\n') return true;
+  return false;
+}
+
+// Helper: Skip to next line, return position after newline
+inline size_t skip_to_next_line(const char* str, size_t pos, size_t len) {
+  while (pos < len && !is_newline(str, pos, len)) {
+    pos++;
+  }
+  if (pos < len) {
+    if (str[pos] == '\r' && pos + 1 < len && str[pos + 1] == '\n') {
+      pos += 2;  // CRLF
+    } else if (str[pos] == '\n') {
+      pos += 1;  // LF
+    }
+  }
+  return pos;
+}
+
+// Helper: Check that only whitespace follows `pos` until newline or EOF
+inline bool is_blank_to_eol(const char* str, size_t pos, size_t len) {
+  while (pos < len && is_whitespace(str[pos])) {
+    pos++;
+  }
+  return pos >= len || is_newline(str, pos, len);
+}
+
+// Custom delimiter spec compiled from `c(opener, prefix, closer)`
+struct CustomFence {
+  std::vector<std::string> opener_lines;
+  std::vector<std::string> closer_lines;
+  std::string prefix;
+  // Prefix without trailing whitespace, e.g. "#" for "# "
+  std::string bare_prefix;
+};
+
+// Result of scanning a document for front matter, as byte offsets into the
+// original text. Content and body strings are materialized separately by
+// front_matter_result(), so the scan itself never copies the document.
+struct FrontMatterScan {
+  bool found = false;
+  // Opening fence matched (the closing fence may still be missing)
+  bool opened = false;
+  const char* format = "none";
+  const char* fence_type = "none";
+  // Built-in comment prefix to unwrap from content, if any
+  const char* comment_prefix = nullptr;
+  // Custom delimiter spec, if the scan used one
+  const CustomFence* custom = nullptr;
+  // Length of the shebang line to prepend to the body (0 for none)
+  size_t shebang_end = 0;
+  size_t content_start = 0;
+  size_t content_end = 0;
+  size_t body_start = 0;
+};
+
+// Progress of the closing fence search over a growing prefix of a document
+//
+// Passing the same ClosingSearch to successive scans of a buffer that only
+// grows at the end makes each scan resume the closing fence search where the
+// previous one stopped, instead of starting over after the opening fence.
+struct ClosingSearch {
+  // Fence type of the opening fence the search belongs to
+  const char* fence_type = nullptr;
+  // Start of the first line that has to be checked again
+  size_t resume = 0;
+};
+
+// Scan for front matter in any of the built-in fence styles
+FrontMatterScan scan_front_matter(const char* str, size_t len, ClosingSearch* search = nullptr);
+
+// Scan for front matter with a custom delimiter
+CustomFence compile_custom_fence(const std::string& opener, const std::string& prefix, const std::string& closer);
+FrontMatterScan scan_custom_front_matter(const char* str, size_t len, const CustomFence& fence);
+
+// Find the start of the body after leading empty lines, or after leading empty
+// lines and at most one bare comment separator line for comment-wrapped
+// formats. Returns `len` if the body is only such lines.
+size_t skip_leading_empty_lines(const char* body, size_t len);
+size_t skip_leading_comment_lines(const char* body, size_t len, const char* prefix);
+
+// Check whether scanning a document prefix has settled the outcome, i.e. more
+// input can't change where the front matter ends or whether there is any
+bool is_header_scan_complete(const char* str, size_t len, const FrontMatterScan& scan);
+
+// Largest chunk read at once by read_front_matter_header()
+const size_t HEADER_MAX_CHUNK_SIZE = 4 * 1024 * 1024;
+
+// Read chunks from `read` into `buffer` until the header scan is complete
+// `read(char* dest, size_t n)` returns the number of bytes read, or 0 at the
+// end of input. A leading UTF-8 BOM is dropped. Returns true if the end of the
+// input was reached.
+//
+// The closing fence search resumes where the previous scan stopped, and chunks
+// double in size up to HEADER_MAX_CHUNK_SIZE, so the cost stays linear in the
+// size of the header even when a fence is opened but never closed.
+template <typename Reader>
+bool read_front_matter_header(Reader& read, std::string& buffer, size_t chunk_size) {
+  ClosingSearch search;
+  bool bom_checked = false;
+
+  while (true) {
+    size_t start = buffer.length();
+    buffer.resize(start + chunk_size);
+    size_t n = read(&buffer[start], chunk_size);
+    buffer.resize(start + n);
+    if (n == 0) return true;
+    if (chunk_size < HEADER_MAX_CHUNK_SIZE) {
+      chunk_size = std::min(chunk_size * 2, HEADER_MAX_CHUNK_SIZE);
+    }
+
+    if (!bom_checked && buffer.length() >= 3) {
+      if (memcmp(buffer.data(), "\xEF\xBB\xBF", 3) == 0) {
+        buffer.erase(0, 3);
+      }
+      bom_checked = true;
+    }
+    if (!bom_checked) continue;
+
+    FrontMatterScan scan = scan_front_matter(buffer.data(), buffer.length(), &search);
+    if (is_header_scan_complete(buffer.data(), buffer.length(), scan)) {
+      return false;
+    }
+  }
+}
+
+// Extract the front matter source between the fences, with any comment prefix
+// removed from each line. Never calls the R API.
+std::string front_matter_content(const std::string& text, const FrontMatterScan& scan);
+
+// Build the R result list (found, format, fence_type, content, body) from a scan
+// With `stats`, also add XXH64 hashes of the content and body and line, word
+// and byte counts of the body.
+cpp11::list front_matter_result(const std::string& text, const FrontMatterScan& scan, bool stats = false);
+
+#endif
@@ -0,0 +1,93 @@
+#include "extract_front_matter.h"
+#include "gz_reader.h"
+#include <atomic>
+#include <thread>
+using namespace cpp11;
+
+// Parallel header extraction
+//
+// find_front_matter() searches the front matter of many files. The headers
+// are read and extracted on worker threads, one file at a time from a shared
+// queue, and only the front matter source is returned to R for filtering and
+// parsing. Workers must never call the R API: readers record errors instead of
+// raising them, and all R objects are built on the main thread.
+
+struct HeaderResult {
+  bool found = false;
+  const char* format = "none";
+  const char* fence_type = "none";
+  std::string content;
+  std::string error;
+};
+
+// Helper: Read a file up to the end of its front matter and extract it
+void read_header(const std::string& path, HeaderResult& result) {
+  try {
+    GzReader read(path, false);
+    std::string text;
+    read_front_matter_header(read, text, HEADER_CHUNK_SIZE);
+    if (!read.error.empty()) {
+      result.error = read.error;
+      return;
+    }
+
+    FrontMatterScan scan = scan_front_matter(text.data(), text.length());
+    result.found = scan.found;
+    result.format = scan.format;
+    result.fence_type = scan.fence_type;
+    result.content = front_matter_content(text, scan);
+  } catch (const std::exception& e) {
+    result.error = "Could not read file " + path + ": " + e.what();
+  }
+}
+
+[[cpp11::register]]
+list read_front_matter_headers_cpp(std::vector<std::string> paths, int threads) {
+  size_t n = paths.size();
+  std::vector<HeaderResult> results(n);
+
+  size_t n_threads = threads > 0 ? threads : std::thread::hardware_concurrency();
+  if (n_threads == 0) n_threads = 1;
+  if (n_threads > n) n_threads = n;
+
+  std::atomic<size_t> next(0);
+  auto work = [&]() {
+    size_t i;
+    while ((i = next++) < n) {
+      read_header(paths[i], results[i]);
+    }
+  };
+
+  if (n_threads <= 1) {
+    work();
+  } else {
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < n_threads; t++) {
+      workers.emplace_back(work);
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+      workers[t].join();
+    }
+  }
+
+  writable::logicals found(n);
+  writable::strings format(n);
+  writable::strings fence_type(n);
+  writable::strings content(n);
+  writable::strings error(n);
+  for (size_t i = 0; i < n; i++) {
+    found[i] = results[i].found;
+    format[i] = results[i].format;
+    fence_type[i] = results[i].fence_type;
+    content[i] = results[i].content;
+    error[i] = results[i].error;
+  }
+
+  writable::list result;
+  result.push_back({"found"_nm = found});
+  result.push_back({"format"_nm = format});
+  result.push_back({"fence_type"_nm = fence_type});
+  result.push_back({"content"_nm = content});
+  result.push_back({"error"_nm = error});
+  return result;
+}
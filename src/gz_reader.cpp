@@ -0,0 +1,27 @@
+#include <string>
+#include <zlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Opening files by UTF-8 path
+//
+// cpp11 passes paths as UTF-8, but on Windows gzopen() interprets them in the
+// ANSI code page, so non-ASCII paths fail to open. There the path is converted
+// to UTF-16 for gzopen_w() instead. This file doesn't include the R headers,
+// which clash with <windows.h>.
+
+gzFile gzopen_utf8(const std::string& path, const char* mode) {
+#ifdef _WIN32
+  int n = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  if (n <= 0) {
+    return nullptr;
+  }
+  std::wstring wide(n, L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], n);
+  return gzopen_w(wide.c_str(), mode);
+#else
+  return gzopen(path.c_str(), mode);
+#endif
+}
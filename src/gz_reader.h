@@ -0,0 +1,110 @@
+#ifndef FRONTMATTER_GZ_READER_H
+#define FRONTMATTER_GZ_READER_H
+
+#include <cpp11.hpp>
+#include <limits>
+#include <string>
+#include <zlib.h>
+
+// zlib's gzread() inflates gzip-compressed files and passes uncompressed files
+// through unchanged, so GzReader reads `.md` and `.md.gz` files alike.
+
+const size_t GZ_BUFFER_SIZE = 128 * 1024;
+
+// Seek with 64-bit offsets where zlib provides them
+#ifdef Z_LARGE64
+typedef z_off64_t gz_off_t;
+#else
+typedef z_off_t gz_off_t;
+#endif
+
+inline gz_off_t gz_seek(gzFile file, gz_off_t offset, int whence) {
+#ifdef Z_LARGE64
+  return gzseek64(file, offset, whence);
+#else
+  return gzseek(file, offset, whence);
+#endif
+}
+
+// Chunk size when only reading up to the end of the front matter
+const size_t HEADER_CHUNK_SIZE = 16 * 1024;
+
+// Open a file given its UTF-8 path, see gz_reader.cpp
+gzFile gzopen_utf8(const std::string& path, const char* mode);
+
+// Owns a gzFile and reads from it as a front matter header Reader
+//
+// Errors raise an R error by default. With `stop_on_error = false`, the first
+// error is kept in `error` and reading stops instead, so that the reader never
+// calls the R API and can be used from worker threads.
+struct GzReader {
+  gzFile file;
+  std::string path;
+  bool stop_on_error;
+  std::string error;
+
+  explicit GzReader(const std::string& path_, bool stop_on_error_ = true)
+    : file(nullptr), path(path_), stop_on_error(stop_on_error_) {
+    file = gzopen_utf8(path, "rb");
+    if (file == nullptr) {
+      fail("Could not open file: " + path);
+      return;
+    }
+    gzbuffer(file, GZ_BUFFER_SIZE);
+  }
+
+  ~GzReader() {
+    if (file != nullptr) gzclose(file);
+  }
+
+  size_t operator()(char* dest, size_t n) {
+    if (file == nullptr || !error.empty()) return 0;
+
+    int bytes = gzread(file, dest, static_cast<unsigned>(n));
+    if (bytes <= 0) {
+      // A truncated gzip stream ends early with Z_BUF_ERROR
+      int errnum = Z_OK;
+      const char* msg = gzerror(file, &errnum);
+      if (bytes < 0 || errnum != Z_OK) {
+        fail("Could not read file " + path + ": " + msg);
+      }
+      return 0;
+    }
+    return static_cast<size_t>(bytes);
+  }
+
+  // Skip `n` bytes of (uncompressed) input
+  //
+  // z_off_t is 32 bits on some platforms, including Windows, so large skips
+  // are split into steps that fit. gzseek() also returns -1 when the new
+  // position doesn't fit in z_off_t, so only a reported error is an error.
+  void skip(size_t n) {
+    if (file == nullptr) return;
+    const size_t max_step = static_cast<size_t>(std::numeric_limits<gz_off_t>::max());
+    while (n > 0) {
+      size_t step = n < max_step ? n : max_step;
+      if (gz_seek(file, static_cast<gz_off_t>(step), SEEK_CUR) < 0) {
+        int errnum = Z_OK;
+        const char* msg = gzerror(file, &errnum);
+        if (errnum != Z_OK) {
+          fail("Could not read file " + path + ": " + msg);
+          return;
+        }
+      }
+      n -= step;
+    }
+  }
+
+private:
+  void fail(const std::string& msg) {
+    if (stop_on_error) {
+      cpp11::stop("%s", msg.c_str());
+    }
+    if (error.empty()) error = msg;
+  }
+
+  GzReader(const GzReader&);
+  GzReader& operator=(const GzReader&);
+};
+
+#endif
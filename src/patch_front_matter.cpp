@@ -0,0 +1,335 @@
+#include "extract_front_matter.h"
+using namespace cpp11;
+
+// Locating top-level values for in-place patching
+//
+// patch_front_matter() rewrites single scalar values without re-serializing
+// the whole header. This file finds the byte span of a top-level key's value
+// inside the front matter region of the original text. Anything that isn't a
+// single-line value (block scalars, nested mappings, multi-line strings or
+// arrays) is reported as "complex" so that the caller can fall back to a full
+// parse and format.
+
+// Helper: Position of the end of the line content (before LF or CRLF)
+inline size_t find_eol(const char* str, size_t pos, size_t len) {
+  while (pos < len && !is_newline(str, pos, len)) {
+    pos++;
+  }
+  return pos;
+}
+
+// Helper: Find the end of a quoted string that starts at `pos`
+// Returns the position after the closing quote, or 0 if the string doesn't
+// close before `eol`. Backslash escapes are honored for `escapes`, and a
+// doubled quote is an escaped quote for `doubled` (YAML single quotes).
+size_t skip_quoted(const char* str, size_t pos, size_t eol, bool escapes, bool doubled) {
+  char quote = str[pos];
+  size_t i = pos + 1;
+  while (i < eol) {
+    if (escapes && str[i] == '\\') {
+      i += 2;
+      continue;
+    }
+    if (str[i] == quote) {
+      if (doubled && i + 1 < eol && str[i + 1] == quote) {
+        i += 2;
+        continue;
+      }
+      return i + 1;
+    }
+    i++;
+  }
+  return 0;
+}
+
+// Helper: Find the end of a flow collection (`[...]` or `{...}`) at `pos`
+// Returns the position after the closing bracket, or 0 if it doesn't close
+// before `eol`.
+size_t skip_balanced(const char* str, size_t pos, size_t eol, bool yaml) {
+  int depth = 0;
+  size_t i = pos;
+  while (i < eol) {
+    char c = str[i];
+    if (c == '"' || c == '\'') {
+      size_t end = skip_quoted(str, i, eol, c == '"', yaml && c == '\'');
+      if (end == 0) return 0;
+      i = end;
+      continue;
+    }
+    if (c == '[' || c == '{') {
+      depth++;
+    } else if (c == ']' || c == '}') {
+      depth--;
+      if (depth == 0) return i + 1;
+    } else if (c == '#' && (!yaml || is_whitespace(str[i - 1]))) {
+      return 0;
+    }
+    i++;
+  }
+  return 0;
+}
+
+// Helper: Check that only whitespace or a comment follows a value
+bool is_value_tail(const char* str, size_t pos, size_t eol, bool yaml) {
+  size_t i = pos;
+  while (i < eol && is_whitespace(str[i])) i++;
+  if (i >= eol) return true;
+  // YAML comments must be separated from the value by whitespace
+  return str[i] == '#' && (!yaml || i > pos);
+}
+
+// Helper: Match a (bare or quoted) key at `pos`, return the position after it
+size_t match_key(const char* str, size_t pos, size_t eol, const std::string& key) {
+  size_t key_len = key.length();
+  if (pos + key_len <= eol && memcmp(str + pos, key.data(), key_len) == 0) {
+    return pos + key_len;
+  }
+  if (pos + key_len + 2 <= eol && (str[pos] == '"' || str[pos] == '\'') &&
+      memcmp(str + pos + 1, key.data(), key_len) == 0 && str[pos + key_len + 1] == str[pos]) {
+    return pos + key_len + 2;
+  }
+  return 0;
+}
+
+enum ValueStatus { VALUE_OK, VALUE_MISSING, VALUE_COMPLEX };
+
+struct ValueSpan {
+  ValueStatus status = VALUE_MISSING;
+  size_t start = 0;
+  size_t end = 0;
+};
+
+// Helper: Find the span of a single-line value starting at `pos`
+ValueSpan find_value_span(const char* str, size_t pos, size_t eol, bool yaml) {
+  ValueSpan span;
+  span.status = VALUE_COMPLEX;
+
+  while (pos < eol && is_whitespace(str[pos])) pos++;
+
+  // Empty value: nested mapping, block sequence or explicit null
+  if (pos >= eol || str[pos] == '#') return span;
+
+  char c = str[pos];
+  size_t end = 0;
+
+  if (c == '"' || c == '\'') {
+    // TOML multi-line strings
+    if (!yaml && pos + 3 <= eol && str[pos + 1] == c && str[pos + 2] == c) {
+      return span;
+    }
+    end = skip_quoted(str, pos, eol, c == '"', yaml && c == '\'');
+    if (end == 0 || !is_value_tail(str, end, eol, yaml)) return span;
+  } else if (c == '[' || c == '{') {
+    end = skip_balanced(str, pos, eol, yaml);
+    if (end == 0 || !is_value_tail(str, end, eol, yaml)) return span;
+  } else if (yaml && strchr("|>&*!%@`", c) != nullptr) {
+    // Block scalars, anchors, aliases, tags and reserved indicators
+    return span;
+  } else {
+    // Plain value until a comment or end of line
+    end = pos;
+    while (end < eol && !(str[end] == '#' && (!yaml || is_whitespace(str[end - 1])))) {
+      end++;
+    }
+    while (end > pos && is_whitespace(str[end - 1])) end--;
+  }
+
+  span.status = VALUE_OK;
+  span.start = pos;
+  span.end = end;
+  return span;
+}
+
+// Helper: Track TOML multi-line strings and arrays that span lines, so that
+// their continuation lines are never mistaken for keys
+struct TomlContinuation {
+  char triple = 0;
+  int depth = 0;
+
+  bool active() const {
+    return triple != 0 || depth > 0;
+  }
+
+  void consume(const char* str, size_t pos, size_t eol) {
+    size_t i = pos;
+    while (i < eol) {
+      char c = str[i];
+      if (triple) {
+        if (c == '\\' && triple == '"') {
+          i += 2;
+          continue;
+        }
+        if (c == triple && i + 3 <= eol && str[i + 1] == c && str[i + 2] == c) {
+          triple = 0;
+          i += 3;
+          continue;
+        }
+        i++;
+        continue;
+      }
+      if (c == '"' || c == '\'') {
+        if (i + 3 <= eol && str[i + 1] == c && str[i + 2] == c) {
+          triple = c;
+          i += 3;
+          continue;
+        }
+        size_t end = skip_quoted(str, i, eol, c == '"', false);
+        i = end == 0 ? eol : end;
+        continue;
+      }
+      if (c == '#') break;
+      if (c == '[' || c == '{') depth++;
+      if (c == ']' || c == '}') depth--;
+      i++;
+    }
+  }
+};
+
+// Helper: Check whether an indented line follows `pos` before the next
+// top-level line. Blank lines fold into a YAML plain scalar, so they are
+// skipped, as are lines that only hold the comment prefix.
+bool has_indented_continuation(const char* str, size_t pos, size_t end, const std::string& prefix) {
+  // Blank comment lines may drop the prefix's trailing whitespace
+  size_t marker_len = prefix.length();
+  while (marker_len > 0 && is_whitespace(prefix[marker_len - 1])) marker_len--;
+
+  while (pos < end) {
+    size_t next = skip_to_next_line(str, pos, end);
+    size_t eol = find_eol(str, pos, end);
+
+    size_t q = pos;
+    if (marker_len > 0) {
+      if (q + marker_len > eol || memcmp(str + q, prefix.data(), marker_len) != 0) {
+        return false;
+      }
+      if (is_blank_to_eol(str, q + marker_len, eol)) {
+        pos = next;
+        continue;
+      }
+      if (q + prefix.length() > eol || memcmp(str + q, prefix.data(), prefix.length()) != 0) {
+        return false;
+      }
+      q += prefix.length();
+    }
+
+    if (!is_blank_to_eol(str, q, eol)) {
+      return is_whitespace(str[q]);
+    }
+    pos = next;
+  }
+  return false;
+}
+
+// Helper: Find the value span of a top-level key within the front matter
+ValueSpan locate_value(const char* str, const FrontMatterScan& scan, const std::string& key) {
+  bool yaml = strcmp(scan.format, "yaml") == 0;
+
+  std::string prefix;
+  if (scan.custom) {
+    prefix = scan.custom->prefix;
+  } else if (scan.comment_prefix) {
+    prefix = scan.comment_prefix;
+  }
+  size_t prefix_len = prefix.length();
+
+  TomlContinuation toml_state;
+  size_t end = scan.content_end;
+  size_t pos = scan.content_start;
+
+  while (pos < end) {
+    size_t next = skip_to_next_line(str, pos, end);
+    size_t eol = find_eol(str, pos, end);
+
+    // Lines without the comment prefix can't hold a key
+    size_t p = pos;
+    if (prefix_len > 0) {
+      if (p + prefix_len > eol || memcmp(str + p, prefix.data(), prefix_len) != 0) {
+        pos = next;
+        continue;
+      }
+      p += prefix_len;
+    }
+
+    if (yaml) {
+      // Top-level keys are never indented
+      size_t after_key = match_key(str, p, eol, key);
+      if (after_key > 0 && after_key < eol && str[after_key] == ':' &&
+          (after_key + 1 >= eol || is_whitespace(str[after_key + 1]))) {
+        ValueSpan span = find_value_span(str, after_key + 1, eol, true);
+
+        // A plain scalar continued on indented lines is multi-line
+        if (span.status == VALUE_OK && has_indented_continuation(str, next, end, prefix)) {
+          span.status = VALUE_COMPLEX;
+        }
+        return span;
+      }
+    } else if (toml_state.active()) {
+      toml_state.consume(str, p, eol);
+    } else {
+      while (p < eol && is_whitespace(str[p])) p++;
+
+      // Keys after the first table header belong to that table
+      if (p < eol && str[p] == '[') {
+        break;
+      }
+
+      size_t after_key = match_key(str, p, eol, key);
+      size_t q = after_key;
+      while (q > 0 && q < eol && is_whitespace(str[q])) q++;
+      if (after_key > 0 && q < eol && str[q] == '=') {
+        return find_value_span(str, q + 1, eol, false);
+      }
+
+      toml_state.consume(str, p, eol);
+    }
+
+    pos = next;
+  }
+
+  return ValueSpan();
+}
+
+// Helper: Build the R result list for the value span of `key`
+list locate_value_result(const char* str, const FrontMatterScan& scan, const std::string& key) {
+  writable::list result;
+  result.push_back({"found"_nm = scan.found});
+  result.push_back({"format"_nm = scan.format});
+  result.push_back({"fence_type"_nm = scan.fence_type});
+
+  ValueSpan span;
+  if (scan.found) {
+    span = locate_value(str, scan, key);
+  }
+
+  const char* status = span.status == VALUE_OK
+    ? "ok"
+    : (span.status == VALUE_COMPLEX ? "complex" : "missing");
+
+  result.push_back({"status"_nm = status});
+  result.push_back({"start"_nm = static_cast<double>(span.start)});
+  result.push_back({"end"_nm = static_cast<double>(span.end)});
+  return result;
+}
+
+[[cpp11::register]]
+list locate_front_matter_value_cpp(std::string text, std::string key, std::string fence_type) {
+  FrontMatterScan scan = scan_front_matter(text.c_str(), text.length());
+
+  // Restrict to a single built-in fence style
+  if (!fence_type.empty() && fence_type != scan.fence_type) {
+    scan = FrontMatterScan();
+  }
+  return locate_value_result(text.c_str(), scan, key);
+}
+
+[[cpp11::register]]
+list locate_front_matter_value_custom_cpp(std::string text, std::string key, std::string opener, std::string prefix, std::string closer, std::string format) {
+  CustomFence fence = compile_custom_fence(opener, prefix, closer);
+  FrontMatterScan scan = scan_custom_front_matter(text.c_str(), text.length(), fence);
+
+  // Custom fences don't imply a format, the caller infers it from the opener
+  if (scan.found) {
+    scan.format = format == "toml" ? "toml" : "yaml";
+  }
+  return locate_value_result(text.c_str(), scan, key);
+}
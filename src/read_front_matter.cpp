@@ -0,0 +1,44 @@
+#include "extract_front_matter.h"
+#include "gz_reader.h"
+using namespace cpp11;
+
+// Streaming file reader
+//
+// When only the header is needed, reading stops as soon as the front matter
+// scan is complete, so the cost depends on the size of the header rather than
+// on the (compressed) body.
+
+// Helper: Read (and inflate) a whole file, dropping a leading UTF-8 BOM
+void read_all(GzReader& read, std::string& buffer) {
+  std::vector<char> chunk(GZ_BUFFER_SIZE);
+  size_t n;
+  while ((n = read(chunk.data(), chunk.size())) > 0) {
+    buffer.append(chunk.data(), n);
+  }
+  if (buffer.length() >= 3 && memcmp(buffer.data(), "\xEF\xBB\xBF", 3) == 0) {
+    buffer.erase(0, 3);
+  }
+}
+
+[[cpp11::register]]
+std::string read_front_matter_text_cpp(std::string path, bool header_only, std::string fence_type) {
+  GzReader read(path);
+  std::string text;
+
+  if (!header_only) {
+    read_all(read, text);
+    return text;
+  }
+
+  bool at_end = read_front_matter_header(read, text, HEADER_CHUNK_SIZE);
+  FrontMatterScan scan = scan_front_matter(text.data(), text.length());
+
+  // Restrict to a single built-in fence style
+  if (!fence_type.empty() && fence_type != scan.fence_type) {
+    text.clear();
+  } else if (!at_end && scan.found) {
+    // Drop the partial body that was read past the closing fence
+    text.resize(scan.body_start);
+  }
+  return text;
+}
@@ -0,0 +1,304 @@
+#include "extract_front_matter.h"
+#include "gz_reader.h"
+using namespace cpp11;
+
+// Jupyter notebook reader
+//
+// Quarto keeps the front matter of `.ipynb` notebooks in the first cell, as
+// the source of a raw (or markdown) cell. Rather than parsing the whole
+// notebook, which may hold large outputs and embedded images, the JSON is
+// streamed just far enough to decode the type and source of the first cell.
+// Other values before it are skipped without being decoded, and nothing after
+// the first cell is read.
+
+const size_t IPYNB_CHUNK_SIZE = 64 * 1024;
+
+// Buffered character stream over a (possibly compressed) file
+class JsonStream {
+public:
+  explicit JsonStream(GzReader& in) : in_(in), buffer_(IPYNB_CHUNK_SIZE), pos_(0), end_(0) {}
+
+  // Next character, or -1 at the end of input
+  int peek() {
+    if (pos_ == end_ && !refill()) return -1;
+    return static_cast<unsigned char>(buffer_[pos_]);
+  }
+
+  int get() {
+    int c = peek();
+    if (c >= 0) pos_++;
+    return c;
+  }
+
+  // Next non-whitespace character, without consuming it
+  int peek_token() {
+    int c = peek();
+    while (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      pos_++;
+      c = peek();
+    }
+    return c;
+  }
+
+  void expect(char expected) {
+    if (peek_token() != expected) {
+      fail(std::string("expected '") + expected + "'");
+    }
+    pos_++;
+  }
+
+  void fail(const std::string& msg) {
+    cpp11::stop("Could not parse notebook %s: %s", in_.path.c_str(), msg.c_str());
+  }
+
+private:
+  bool refill() {
+    end_ = in_(buffer_.data(), buffer_.size());
+    pos_ = 0;
+    return end_ > 0;
+  }
+
+  GzReader& in_;
+  std::vector<char> buffer_;
+  size_t pos_;
+  size_t end_;
+};
+
+// Helper: Append a Unicode code point to `out` as UTF-8
+void append_utf8(std::string& out, unsigned long cp) {
+  if (cp < 0x80) {
+    out += static_cast<char>(cp);
+  } else if (cp < 0x800) {
+    out += static_cast<char>(0xC0 | (cp >> 6));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    out += static_cast<char>(0xE0 | (cp >> 12));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (cp >> 18));
+    out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (cp & 0x3F));
+  }
+}
+
+// Helper: Read the 4 hex digits of a \uXXXX escape
+unsigned long read_hex4(JsonStream& json) {
+  unsigned long value = 0;
+  for (int i = 0; i < 4; i++) {
+    int c = json.get();
+    value <<= 4;
+    if (c >= '0' && c <= '9') {
+      value |= c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      value |= c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      value |= c - 'A' + 10;
+    } else {
+      json.fail("invalid \\u escape");
+    }
+  }
+  return value;
+}
+
+// Helper: Append the value of a single-character escape, e.g. `n` for "\n"
+void append_escape(JsonStream& json, int c, std::string& out) {
+  switch (c) {
+  case '"': out += '"'; break;
+  case '\\': out += '\\'; break;
+  case '/': out += '/'; break;
+  case 'b': out += '\b'; break;
+  case 'f': out += '\f'; break;
+  case 'n': out += '\n'; break;
+  case 'r': out += '\r'; break;
+  case 't': out += '\t'; break;
+  default: json.fail("invalid escape");
+  }
+}
+
+// Read a JSON string, appending its decoded value to `out` (if not null)
+void read_json_string(JsonStream& json, std::string* out) {
+  json.expect('"');
+
+  while (true) {
+    int c = json.get();
+    if (c < 0) json.fail("unterminated string");
+    if (c == '"') return;
+
+    if (c != '\\') {
+      if (out) *out += static_cast<char>(c);
+      continue;
+    }
+
+    c = json.get();
+    if (c != 'u') {
+      if (out) append_escape(json, c, *out);
+      continue;
+    }
+
+    unsigned long cp = read_hex4(json);
+    if (!out) continue;
+
+    // Combine UTF-16 surrogate pairs, replace lone surrogates with U+FFFD
+    if (cp >= 0xD800 && cp <= 0xDBFF && json.peek() == '\\') {
+      json.get();
+      c = json.get();
+      if (c != 'u') {
+        append_utf8(*out, 0xFFFD);
+        append_escape(json, c, *out);
+        continue;
+      }
+      unsigned long low = read_hex4(json);
+      if (low >= 0xDC00 && low <= 0xDFFF) {
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+      } else {
+        append_utf8(*out, 0xFFFD);
+        cp = low;
+      }
+    }
+    if (cp >= 0xD800 && cp <= 0xDFFF) cp = 0xFFFD;
+    append_utf8(*out, cp);
+  }
+}
+
+// Skip any JSON value without decoding it
+void skip_json_value(JsonStream& json) {
+  int c = json.peek_token();
+
+  if (c == '"') {
+    read_json_string(json, nullptr);
+    return;
+  }
+
+  if (c == '{' || c == '[') {
+    // Strings are skipped whole, so brackets inside them aren't counted
+    int depth = 0;
+    do {
+      c = json.peek_token();
+      if (c < 0) json.fail("unexpected end of input");
+      if (c == '"') {
+        read_json_string(json, nullptr);
+        continue;
+      }
+      if (c == '{' || c == '[') depth++;
+      if (c == '}' || c == ']') depth--;
+      json.get();
+    } while (depth > 0);
+    return;
+  }
+
+  // Numbers, true, false and null
+  bool empty = true;
+  while (c >= 0 && c != ',' && c != '}' && c != ']' &&
+         c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+    json.get();
+    c = json.peek();
+    empty = false;
+  }
+  if (empty) json.fail("expected a value");
+}
+
+// Helper: Advance past the separator after an object member or array element
+// Returns false at the closing bracket
+bool next_json_item(JsonStream& json, char close) {
+  int c = json.peek_token();
+  if (c == ',') {
+    json.get();
+    return true;
+  }
+  if (c == close) {
+    json.get();
+    return false;
+  }
+  json.fail(std::string("expected ',' or '") + close + "'");
+  return false;
+}
+
+// Helper: Check whether an object or array is empty, consuming its closer if so
+bool is_empty_json_container(JsonStream& json, char close) {
+  if (json.peek_token() == close) {
+    json.get();
+    return true;
+  }
+  return false;
+}
+
+// Read a cell's `source`, either a string or an array of strings (lines)
+void read_cell_source(JsonStream& json, std::string& source) {
+  if (json.peek_token() == '"') {
+    read_json_string(json, &source);
+    return;
+  }
+
+  json.expect('[');
+  if (is_empty_json_container(json, ']')) return;
+  do {
+    read_json_string(json, &source);
+  } while (next_json_item(json, ']'));
+}
+
+// Read the first cell object, keeping its type and source
+void read_first_cell(JsonStream& json, std::string& cell_type, std::string& source) {
+  json.expect('{');
+  if (is_empty_json_container(json, '}')) return;
+
+  std::string key;
+  do {
+    key.clear();
+    read_json_string(json, &key);
+    json.expect(':');
+
+    if (key == "cell_type") {
+      cell_type.clear();
+      read_json_string(json, &cell_type);
+    } else if (key == "source") {
+      source.clear();
+      read_cell_source(json, source);
+    } else {
+      skip_json_value(json);
+    }
+  } while (next_json_item(json, '}'));
+}
+
+[[cpp11::register]]
+list read_ipynb_first_cell_cpp(std::string path) {
+  GzReader read(path);
+  JsonStream json(read);
+
+  // Skip a UTF-8 BOM
+  if (json.peek() == 0xEF) {
+    json.get();
+    if (json.get() != 0xBB || json.get() != 0xBF) json.fail("invalid UTF-8 BOM");
+  }
+
+  std::string cell_type = "none";
+  std::string source;
+
+  json.expect('{');
+  if (!is_empty_json_container(json, '}')) {
+    std::string key;
+    do {
+      key.clear();
+      read_json_string(json, &key);
+      json.expect(':');
+
+      if (key != "cells") {
+        skip_json_value(json);
+        continue;
+      }
+
+      // Stop reading as soon as the first cell is done
+      json.expect('[');
+      if (!is_empty_json_container(json, ']')) {
+        read_first_cell(json, cell_type, source);
+      }
+      break;
+    } while (next_json_item(json, '}'));
+  }
+
+  writable::list result;
+  result.push_back({"cell_type"_nm = cell_type});
+  result.push_back({"source"_nm = source});
+  return result;
+}
@@ -0,0 +1,193 @@
+#include "extract_front_matter.h"
+#include "gz_reader.h"
+using namespace cpp11;
+
+// Tar archive reader
+//
+// Walks a (optionally gzip-compressed) tar archive in a single sequential pass.
+// For each regular file member, only the front matter header is read; the rest
+// of the member is skipped without being copied. Members are filtered by path
+// with an R predicate, so that `pattern` uses R's regular expressions, before
+// any of their data is read.
+// Supports ustar names (with prefix), GNU long names ('L') and pax "path"
+// records ('x').
+
+const size_t TAR_BLOCK_SIZE = 512;
+
+// Helper: Parse a numeric tar header field (octal or GNU base-256)
+size_t parse_tar_number(const char* field, size_t width) {
+  const unsigned char* f = reinterpret_cast<const unsigned char*>(field);
+
+  if (f[0] & 0x80) {
+    // Base-256: big-endian binary number in the remaining bytes
+    size_t value = f[0] & 0x7F;
+    for (size_t i = 1; i < width; i++) {
+      value = (value << 8) | f[i];
+    }
+    return value;
+  }
+
+  size_t value = 0;
+  size_t i = 0;
+  while (i < width && (field[i] == ' ' || field[i] == '\0')) i++;
+  while (i < width && field[i] >= '0' && field[i] <= '7') {
+    value = value * 8 + (field[i] - '0');
+    i++;
+  }
+  return value;
+}
+
+// Helper: Copy a NUL-terminated (or full-width) header field
+std::string tar_field(const char* field, size_t width) {
+  size_t n = 0;
+  while (n < width && field[n] != '\0') n++;
+  return std::string(field, n);
+}
+
+// Helper: Validate the header checksum (checksum field counted as spaces)
+bool is_valid_tar_header(const char* block) {
+  const unsigned char* b = reinterpret_cast<const unsigned char*>(block);
+  size_t sum = 0;
+  for (size_t i = 0; i < TAR_BLOCK_SIZE; i++) {
+    sum += (i >= 148 && i < 156) ? ' ' : b[i];
+  }
+  return sum == parse_tar_number(block + 148, 8);
+}
+
+// Helper: Find the "path" record in pax extended header data
+// Records have the form "<length> <key>=<value>\n"
+std::string pax_path(const std::string& data) {
+  size_t pos = 0;
+  while (pos < data.length()) {
+    size_t space = data.find(' ', pos);
+    if (space == std::string::npos) break;
+    size_t record_len = strtoul(data.c_str() + pos, nullptr, 10);
+    if (record_len == 0 || pos + record_len > data.length()) break;
+
+    size_t eq = data.find('=', space);
+    size_t record_end = pos + record_len;
+    if (eq != std::string::npos && eq < record_end &&
+        data.compare(space + 1, eq - space - 1, "path") == 0) {
+      // Drop the trailing newline
+      return data.substr(eq + 1, record_end - eq - 2);
+    }
+    pos = record_end;
+  }
+  return "";
+}
+
+// Reads at most `remaining` bytes of the current member
+struct TarMemberReader {
+  GzReader& archive;
+  size_t remaining;
+
+  size_t operator()(char* dest, size_t n) {
+    if (n > remaining) n = remaining;
+    if (n == 0) return 0;
+    size_t bytes = archive(dest, n);
+    if (bytes == 0) {
+      cpp11::stop("Unexpected end of tar archive: %s", archive.path.c_str());
+    }
+    remaining -= bytes;
+    return bytes;
+  }
+};
+
+// Helper: Read exactly `n` bytes of member data into `out`
+void read_tar_data(GzReader& archive, size_t n, std::string& out) {
+  out.resize(n);
+  TarMemberReader read = {archive, n};
+  size_t got = 0;
+  while (got < n) {
+    got += read(&out[got], n - got);
+  }
+}
+
+inline size_t tar_padding(size_t size) {
+  return (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+}
+
+[[cpp11::register]]
+list read_tar_front_matter_cpp(std::string path, SEXP keep) {
+  GzReader archive(path);
+  bool filter = keep != R_NilValue;
+
+  std::vector<std::string> paths;
+  std::vector<std::string> headers;
+  std::string long_name;
+  char block[TAR_BLOCK_SIZE];
+
+  while (true) {
+    size_t got = 0;
+    while (got < TAR_BLOCK_SIZE) {
+      size_t n = archive(block + got, TAR_BLOCK_SIZE - got);
+      if (n == 0) break;
+      got += n;
+    }
+
+    // A missing or zero-filled block marks the end of the archive
+    if (got == 0) break;
+    if (got < TAR_BLOCK_SIZE) {
+      cpp11::stop("Unexpected end of tar archive: %s", path.c_str());
+    }
+    bool all_zero = true;
+    for (size_t i = 0; i < TAR_BLOCK_SIZE && all_zero; i++) {
+      all_zero = block[i] == '\0';
+    }
+    if (all_zero) break;
+
+    if (!is_valid_tar_header(block)) {
+      cpp11::stop("Invalid tar header in archive: %s", path.c_str());
+    }
+
+    size_t size = parse_tar_number(block + 124, 12);
+    char type = block[156];
+    size_t padded = size + tar_padding(size);
+
+    // GNU long name and pax extended headers apply to the next member
+    if (type == 'L' || type == 'x') {
+      std::string data;
+      read_tar_data(archive, size, data);
+      archive.skip(tar_padding(size));
+      long_name = type == 'L' ? tar_field(data.data(), data.length()) : pax_path(data);
+      continue;
+    }
+
+    std::string name;
+    if (!long_name.empty()) {
+      name = long_name;
+      long_name.clear();
+    } else {
+      name = tar_field(block, 100);
+      if (memcmp(block + 257, "ustar", 5) == 0) {
+        std::string prefix = tar_field(block + 345, 155);
+        if (!prefix.empty()) name = prefix + "/" + name;
+      }
+    }
+
+    bool is_file = type == '0' || type == '\0' || type == '7';
+    if (!is_file || (filter && !cpp11::as_cpp<bool>(cpp11::function(keep)(name)))) {
+      archive.skip(padded);
+      continue;
+    }
+
+    TarMemberReader read = {archive, size};
+    std::string header;
+    read_front_matter_header(read, header, HEADER_CHUNK_SIZE);
+
+    // Keep only the front matter: drop the partial body that was read past the
+    // closing fence, and everything from members without front matter (which
+    // may well be binary)
+    FrontMatterScan scan = scan_front_matter(header.data(), header.length());
+    header.resize(scan.found ? scan.body_start : 0);
+
+    paths.push_back(name);
+    headers.push_back(header);
+    archive.skip(read.remaining + tar_padding(size));
+  }
+
+  writable::list result;
+  result.push_back({"path"_nm = paths});
+  result.push_back({"text"_nm = headers});
+  return result;
+}
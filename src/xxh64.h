@@ -0,0 +1,167 @@
+#ifndef FRONTMATTER_XXH64_H
+#define FRONTMATTER_XXH64_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// XXH64 non-cryptographic hash (https://xxhash.com), with seed 0
+//
+// The input is hashed in 32-byte stripes and `visit(ptr, n)` is called on
+// every byte of input once, stripe by stripe, as it is hashed, so that other
+// per-byte statistics can be collected in the same pass over the data.
+
+const uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+const uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t xxh_rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// Little-endian reads, independent of the platform's byte order
+inline uint64_t xxh_read64(const unsigned char* p) {
+  uint64_t v = 0;
+  for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+  return v;
+}
+
+inline uint64_t xxh_read32(const unsigned char* p) {
+  return static_cast<uint64_t>(p[0]) | (static_cast<uint64_t>(p[1]) << 8) |
+    (static_cast<uint64_t>(p[2]) << 16) | (static_cast<uint64_t>(p[3]) << 24);
+}
+
+inline uint64_t xxh64_round(uint64_t acc, uint64_t input) {
+  acc += input * XXH_PRIME64_2;
+  acc = xxh_rotl64(acc, 31);
+  return acc * XXH_PRIME64_1;
+}
+
+inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t val) {
+  acc ^= xxh64_round(0, val);
+  return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+// Streaming XXH64 state, so that input in several pieces hashes like their
+// concatenation
+class Xxh64 {
+public:
+  Xxh64() : v1(XXH_PRIME64_1 + XXH_PRIME64_2), v2(XXH_PRIME64_2), v3(0),
+    v4(0 - XXH_PRIME64_1), total(0), buffered(0) {}
+
+  template <typename Visit>
+  void update(const char* data, size_t len, Visit& visit) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + len;
+    total += len;
+
+    // Complete the stripe left over from the previous piece
+    if (buffered > 0) {
+      size_t n = 32 - buffered < len ? 32 - buffered : len;
+      visit(data, n);
+      memcpy(buffer + buffered, p, n);
+      buffered += n;
+      p += n;
+      if (buffered < 32) return;
+      consume(buffer);
+      buffered = 0;
+    }
+
+    while (end - p >= 32) {
+      visit(reinterpret_cast<const char*>(p), 32);
+      consume(p);
+      p += 32;
+    }
+
+    if (p < end) {
+      buffered = static_cast<size_t>(end - p);
+      visit(reinterpret_cast<const char*>(p), buffered);
+      memcpy(buffer, p, buffered);
+    }
+  }
+
+  uint64_t digest() const {
+    uint64_t h;
+    if (total >= 32) {
+      h = xxh_rotl64(v1, 1) + xxh_rotl64(v2, 7) + xxh_rotl64(v3, 12) + xxh_rotl64(v4, 18);
+      h = xxh64_merge_round(h, v1);
+      h = xxh64_merge_round(h, v2);
+      h = xxh64_merge_round(h, v3);
+      h = xxh64_merge_round(h, v4);
+    } else {
+      h = XXH_PRIME64_5;
+    }
+
+    h += total;
+
+    const unsigned char* p = buffer;
+    const unsigned char* end = buffer + buffered;
+    while (end - p >= 8) {
+      h ^= xxh64_round(0, xxh_read64(p));
+      h = xxh_rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+      p += 8;
+    }
+    if (end - p >= 4) {
+      h ^= xxh_read32(p) * XXH_PRIME64_1;
+      h = xxh_rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+      p += 4;
+    }
+    while (p < end) {
+      h ^= (*p) * XXH_PRIME64_5;
+      h = xxh_rotl64(h, 11) * XXH_PRIME64_1;
+      p++;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+  }
+
+private:
+  uint64_t v1, v2, v3, v4;
+  uint64_t total;
+  unsigned char buffer[32];
+  size_t buffered;
+
+  void consume(const unsigned char* p) {
+    v1 = xxh64_round(v1, xxh_read64(p));
+    v2 = xxh64_round(v2, xxh_read64(p + 8));
+    v3 = xxh64_round(v3, xxh_read64(p + 16));
+    v4 = xxh64_round(v4, xxh_read64(p + 24));
+  }
+};
+
+template <typename Visit>
+uint64_t xxh64(const char* data, size_t len, Visit& visit) {
+  Xxh64 state;
+  state.update(data, len, visit);
+  return state.digest();
+}
+
+struct XxhNoVisit {
+  void operator()(const char*, size_t) {}
+};
+
+inline uint64_t xxh64(const char* data, size_t len) {
+  XxhNoVisit visit;
+  return xxh64(data, len, visit);
+}
+
+// Format a hash as 16 lowercase hex digits
+inline std::string xxh64_hex(uint64_t h) {
+  static const char digits[] = "0123456789abcdef";
+  std::string out(16, '0');
+  for (int i = 15; i >= 0; i--) {
+    out[i] = digits[h & 0xF];
+    h >>= 4;
+  }
+  return out;
+}
+
+#endif